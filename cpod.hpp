@@ -38,7 +38,18 @@
 #include <tuple>
 #include <type_traits>
 #include <charconv>  // from_chars and to_chars
+#include <limits>
 #include <format>    // for format api.
+#include <memory_resource>
+#include <memory>    // to_address
+#include <bit>       // bit_cast
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <numeric>   // iota
 
 // Container support headers.
 #include <array>
@@ -57,6 +68,155 @@ namespace cpod {
     using  flag_t = std::uint32_t;
     class  archive;
 
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ///                                   Byte code layout (version 3)
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    //
+    // header : "CPOD" | u32 version | u32 byte order mark | u32 reserved
+    // record : u64 size of the rest | u64 key | type signature '\0' | name '\0' | pad to 8 | value | pad to 8
+    // end    : u64 0
+    //
+    // The key is a FNV-1a hash of signature and name including both NULs, lookups compare it before the bytes.
+    // Integers are in the writer's byte order, readers refuse an archive whose mark does not match theirs.
+    // Arithmetic values are aligned to their size, strings are a u64 length followed by their bytes, resizable
+    // containers a u64 element count followed by the elements, and fixed size aggregates (pair, tuple, array,
+    // struct) only their elements. Alignment is relative to the buffer start, which must be 8 byte aligned,
+    // any heap allocated std::string is.
+
+    namespace byte_code {
+        inline constexpr char           magic[4]        = { 'C', 'P', 'O', 'D' };
+        inline constexpr std::uint32_t  version         = 4;
+        inline constexpr std::uint32_t  byte_order_mark = 0x01020304;
+        inline constexpr std::size_t    header_size     = 16;
+        inline constexpr std::size_t    record_align    = 8;
+
+        template <class Buffer>
+        constexpr void pad(Buffer& buf, std::size_t align) {
+            buf.append((align - buf.size() % align) % align, '\0');
+        }
+
+        template <class Ty, class Buffer>
+        constexpr void put(Buffer& buf, const Ty& value) {
+            pad(buf, sizeof(Ty));
+            buf.append(reinterpret_cast<const char*>(&value), sizeof(Ty));
+        }
+
+        template <class Buffer>
+        constexpr void put_header(Buffer& buf) {
+            buf.append(magic, sizeof(magic));
+            put(buf, version);
+            put(buf, byte_order_mark);
+            put(buf, std::uint32_t{ 0 });
+        }
+
+        inline void align(std::string::const_iterator& iter, std::size_t align) {
+            auto address = reinterpret_cast<std::uintptr_t>(std::to_address(iter));
+            iter += static_cast<std::ptrdiff_t>((align - address % align) % align);
+        }
+
+        template <class Ty>
+        inline Ty get(std::string::const_iterator& iter) {
+            align(iter, sizeof(Ty));
+            Ty value;
+            std::memcpy(&value, std::to_address(iter), sizeof(Ty));
+            iter += sizeof(Ty);
+            return value;
+        }
+
+        constexpr std::uint64_t hash(std::string_view bytes, std::uint64_t h = 0xcbf29ce484222325ull) {
+            for (char c : bytes) {
+                h ^= static_cast<unsigned char>(c);
+                h *= 0x100000001b3ull;
+            }
+            return h;
+        }
+
+        // Throws when content is not current byte code produced on a machine of the same byte order.
+        inline void check_header(std::string_view content) {
+            if (content.size() < header_size + sizeof(std::uint64_t) || std::memcmp(content.data(), magic, sizeof(magic)) != 0) {
+                throw std::invalid_argument("Content is not compiled cpod byte code!");
+            }
+            if (reinterpret_cast<std::uintptr_t>(content.data()) % record_align != 0) {
+                throw std::invalid_argument("Byte code buffer is not 8 byte aligned!");
+            }
+            std::uint32_t v = 0, mark = 0;
+            std::memcpy(&v,    content.data() + 4, sizeof(v));
+            std::memcpy(&mark, content.data() + 8, sizeof(mark));
+            if (mark != byte_order_mark) {
+                throw std::invalid_argument("Byte code was written with a different byte order!");
+            }
+            if (v != version) {
+                throw std::invalid_argument("Unsupported byte code version!");
+            }
+        }
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////
+    ///                                     Diagnostics
+    //////////////////////////////////////////////////////////////////////////////////////////////
+
+    typedef enum diagnostic_severity {
+        severity_warning = 1,
+        severity_error   = 2,
+    } diagnostic_severity;
+
+    // Line and column are 1 based and refer to the source given to the compiler, #line directives in it
+    // renumber the following lines and may name the file.
+    struct diagnostic {
+        std::string            file;
+        std::size_t            line;
+        std::size_t            column;
+        diagnostic_severity    severity;
+        std::string            message;
+    };
+
+    inline std::string to_string(const diagnostic& d) {
+        return std::format("{:s}:{:d}:{:d}: {:s}: {:s}", d.file.empty() ? "<source>" : d.file, d.line, d.column,
+                           d.severity == severity_error ? "error" : "warning", d.message);
+    }
+
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////
+    ///                                           Include cache
+    //////////////////////////////////////////////////////////////////////////////////////////////////////////
+
+    // An #include or #line line, the include pass only looks at these.
+    struct include_directive {
+        std::size_t     begin;          // Of the line.
+        std::size_t     end;            // After its newline.
+        std::size_t     line;           // 1 based.
+        bool            is_include;     // Otherwise #line.
+        bool            angled;         // #include <name>.
+        std::size_t     number;         // Of #line.
+        std::string     name;           // Included name, or the file named by #line.
+    };
+
+    // Directives are lines whose first non space character is #.
+    inline std::vector<include_directive> scan_include_directives(std::string_view text);
+
+    // Files loaded by #include during one run. Each is read and scanned once and shared by every archive
+    // compiled with the cache, lookups are thread safe.
+    class include_cache {
+    public:
+        struct file {
+            std::string                     path;
+            std::string                     text;
+            std::vector<include_directive>  directives;
+            std::string                     guard;      // Of an #ifndef/#define ... #endif around the whole file.
+            bool                            once;       // Has #pragma once.
+        };
+
+        explicit include_cache(std::vector<std::string> directories = {}) : directories_(std::move(directories)) {}
+
+        // Quoted names are looked up next to the including file first, then in the directories.
+        // Null when there is no such file.
+        inline const file* find(std::string_view name, std::string_view including_file, bool angled);
+
+    private:
+        std::mutex                                              mutex_;
+        std::vector<std::string>                                directories_;
+        std::unordered_map<std::string, std::unique_ptr<file>>  files_;     // By normalized path, null when missing.
+    };
+
     //////////////////////////////////////////////////////////////////////////////////////////////////////////
     ///                                   Variable view implementation
     //////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -114,22 +274,47 @@ namespace cpod {
     //////////////////////////////////////////////////////////////////////////////////////////////////////////
     
     class archive {
-        std::string   content_;
-        std::size_t   base_indent_count_;
+        std::string                  content_;
+        std::size_t                  base_indent_count_;
+        // Compiler temporaries are allocated from here, content_ itself is not.
+        std::pmr::memory_resource*   resource_;
     public:
         
         // Writer mode
-        archive(std::size_t bic = 0, char bi = ' ') : content_(), base_indent_count_(bic) {}
+        archive(std::size_t bic = 0, char bi = ' ', std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : content_(), base_indent_count_(bic), resource_(mr) {}
         // Reader mode
-        archive(std::string_view c) : content_(c), base_indent_count_(0) {}
+        archive(std::string_view c, std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : content_(c), base_indent_count_(0), resource_(mr) {}
         
         constexpr std::string&                   content()       { return content_; }
         constexpr std::string_view               content() const { return content_; }
 
+        constexpr std::pmr::memory_resource*     resource() const { return resource_; }
+
         constexpr std::string::const_iterator    content_end() const { return content_.cend(); }
 
-        // Compile writes compiled code stream to content_.
-        inline    std::string         compile_content_default(const std::unordered_map<std::string_view, std::string>& init_macro_map = {}) noexcept;
+        // Compile writes compiled code stream to content_, records before an error stay readable.
+        // Included files are loaded through includes, or a cache of this call when null.
+        // Records in namespace blocks are named a::b::name, namespaces receives the qualified block names.
+        inline    std::vector<diagnostic> compile_content(const std::unordered_map<std::string_view, std::string>& init_macro_map = {},
+                                                          include_cache* includes = nullptr,
+                                                          std::vector<std::string>* namespaces = nullptr) noexcept;
+        // Same, returns the diagnostics one per line, empty when it compiled cleanly.
+        inline    std::string         compile_content_default(const std::unordered_map<std::string_view, std::string>& init_macro_map = {},
+                                                              include_cache* includes = nullptr) noexcept;
+
+        // An independent piece of source for compile_many.
+        struct section;
+
+        // Compiles every section on up to thread_count threads (0 means one per core), sharing only the
+        // read-only macro map and the include cache, one for this call when null. Each worker allocates
+        // temporaries from its own arena over upstream, which must be thread-safe, section resources are not used.
+        static    void                compile_many(std::span<section> sections,
+                                                   const std::unordered_map<std::string_view, std::string>& init_macro_map = {},
+                                                   std::size_t thread_count = 0,
+                                                   include_cache* includes = nullptr,
+                                                   std::pmr::memory_resource* upstream = std::pmr::new_delete_resource());
 
         template <class Ty>
         constexpr std::string::const_iterator find_variable_begin(std::string_view var_name);
@@ -381,21 +566,56 @@ template <typename K, typename V, typename ... OtherStuff> \
             }
             template <class Reader>
             constexpr auto operator()(std::string::const_iterator& iter, Reader reader, STL& value, int department) {
-                const std::size_t n = *reinterpret_cast<const std::size_t*>(&*iter);
-                iter += sizeof(std::size_t);
-                auto inserter = std::inserter(value, value.end());
-                for (std::size_t i = 0; i != n; ++i) {
-                    if constexpr (std_template_library_type_traits<STL>::is_mono) {
-                        typename STL::value_type cache;
-                        iterate_std_template_stuff_impl<typename STL::value_type>{}(iter, reader, cache, department);
-                        *inserter++ = std::move(cache);
+                using element = typename STL::value_type;
+                const std::size_t n = static_cast<std::size_t>(byte_code::get<std::uint64_t>(iter));
+                if constexpr (requires { value.reserve(n); }) {
+                    value.reserve(value.size() + n);
+                }
+                if constexpr (std_template_library_type_traits<STL>::is_mono) {
+                    // Arithmetic elements are stored back to back, copy them in one go.
+                    if constexpr (std::is_arithmetic_v<element> && std::ranges::contiguous_range<STL>) {
+                        if (n == 0) { return; }
+                        byte_code::align(iter, sizeof(element));
+                        const std::size_t old = value.size();
+                        value.resize(old + n);
+                        std::memcpy(value.data() + old, std::to_address(iter), n * sizeof(element));
+                        iter += static_cast<std::ptrdiff_t>(n * sizeof(element));
+                    }
+                    // Sequences read straight into their new back element.
+                    else if constexpr (requires { { value.emplace_back() } -> std::same_as<element&>; }) {
+                        for (std::size_t i = 0; i != n; ++i) {
+                            iterate_std_template_stuff_impl<element>{}(iter, reader, value.emplace_back(), department);
+                        }
+                    }
+                    else if constexpr (requires { value.emplace_after(value.before_begin()); }) {
+                        auto tail = value.before_begin();
+                        for (auto next = std::next(tail); next != value.end(); ++next) { tail = next; }
+                        for (std::size_t i = 0; i != n; ++i) {
+                            tail = value.emplace_after(tail);
+                            iterate_std_template_stuff_impl<element>{}(iter, reader, *tail, department);
+                        }
                     }
-                    else if constexpr (std_template_library_type_traits<STL>::is_double) {
-                        typename STL::key_type                key;
-                        typename STL::value_type::second_type val;
-                        iterate_std_template_stuff_impl<typename STL::key_type>{}               (iter, reader, key, department);
-                        iterate_std_template_stuff_impl<typename STL::value_type::second_type>{}(iter, reader, val, department);
-                        *inserter++ = std::make_pair(key, val);
+                    // Sets were written in their own order, so the end hint is right for ordered ones.
+                    // Proxy sequences like std::vector<bool> take a copy.
+                    else {
+                        for (std::size_t i = 0; i != n; ++i) {
+                            element cache{};
+                            iterate_std_template_stuff_impl<element>{}(iter, reader, cache, department);
+                            if constexpr (requires { value.emplace_hint(value.end(), std::move(cache)); }) {
+                                value.emplace_hint(value.end(), std::move(cache));
+                            } else {
+                                value.push_back(cache);
+                            }
+                        }
+                    }
+                }
+                else if constexpr (std_template_library_type_traits<STL>::is_double) {
+                    for (std::size_t i = 0; i != n; ++i) {
+                        typename STL::key_type           key{};
+                        typename element::second_type    val{};
+                        iterate_std_template_stuff_impl<typename STL::key_type>{}       (iter, reader, key, department);
+                        iterate_std_template_stuff_impl<typename element::second_type>{}(iter, reader, val, department);
+                        value.emplace_hint(value.end(), std::move(key), std::move(val));
                     }
                 }
             }
@@ -425,7 +645,7 @@ template <typename K, typename V, typename ... OtherStuff> \
             template <class Reader>
             constexpr auto operator()(std::string::const_iterator& iter, Reader reader, std::pair<F, S>& value, int department) {
                 iterate_std_template_stuff_impl<F>{}(iter, reader, value.first, department);
-                iterate_std_template_stuff_impl<F>{}(iter, reader, value.second, department);
+                iterate_std_template_stuff_impl<S>{}(iter, reader, value.second, department);
             }
         };
         
@@ -456,8 +676,9 @@ template <typename K, typename V, typename ... OtherStuff> \
                 if (!bin) {
                     buf.append(std::to_string(N)).push_back('>');
                 } else {
-                    const std::size_t n = N;
-                    buf.append(reinterpret_cast<const char*>(&n), sizeof(std::size_t)).push_back('>');
+                    // bit_cast keeps this usable in constant evaluation, see binary_signature.
+                    const auto n = std::bit_cast<std::array<char, sizeof(std::uint64_t)>>(static_cast<std::uint64_t>(N));
+                    buf.append(n.data(), n.size()).push_back('>');
                 }
                 buf.push_back(',');
             }
@@ -470,7 +691,13 @@ template <typename K, typename V, typename ... OtherStuff> \
             }
             template <class Reader>
             constexpr auto operator()(std::string::const_iterator& iter, Reader reader, std::array<Ty, N>& value, int department) {
-                read_array(iter, reader, value, department);
+                if constexpr (std::is_arithmetic_v<Ty>) {
+                    byte_code::align(iter, sizeof(Ty));
+                    std::memcpy(value.data(), std::to_address(iter), N * sizeof(Ty));
+                    iter += static_cast<std::ptrdiff_t>(N * sizeof(Ty));
+                } else {
+                    read_array(iter, reader, value, department);
+                }
             }
         };
 
@@ -543,6 +770,31 @@ template <typename K, typename V, typename ... OtherStuff> \
         return buf;
     }
 
+    namespace details {
+        template <class Ty>
+        constexpr std::string binary_signature_string() {
+            if constexpr (std_type<Ty>) {
+                return std_type_name_string<Ty>(true);
+            } else {
+                return structure_type_name_string<Ty>();
+            }
+        }
+
+        // Record signature of Ty and its hash, evaluated once per type at compile time.
+        template <class Ty>
+        struct binary_signature {
+            static constexpr std::size_t size = binary_signature_string<Ty>().size();
+            static constexpr std::array<char, size> bytes = [] {
+                std::array<char, size> a{};
+                const std::string s = binary_signature_string<Ty>();
+                std::copy(s.begin(), s.end(), a.begin());
+                return a;
+            }();
+            static constexpr std::string_view view{ bytes.data(), bytes.size() };
+            static constexpr std::uint64_t    key = byte_code::hash(view);
+        };
+    }
+
     template <typename Ty, class Formatter>
     constexpr auto std_type_value_string(const Ty& value, Formatter formatter) {
         std::string buffer;
@@ -623,18 +875,16 @@ template <typename K, typename V, typename ... OtherStuff> \
         
         template <details::std_basic_type Ty>
         constexpr void operator()(std::string::const_iterator& iter, Ty& value) {
-            if (std::is_arithmetic_v<Ty>) {
-                value = *reinterpret_cast<const Ty*>(&*iter);
-                iter += sizeof(Ty);
+            if constexpr (std::is_arithmetic_v<Ty>) {
+                value = byte_code::get<Ty>(iter);
             }
             else if constexpr (details::std_string_type_traits<Ty>::value) {
                 if constexpr (details::std_string_type_traits<Ty>::is_view) {
                     throw std::invalid_argument("Reader can not accept a string_view");
                 }
-                const std::size_t len = std::strlen(&*iter);
-                value.resize(len);
-                std::memcpy(value.data(), &*iter, len);
-                iter += static_cast<std::ptrdiff_t>(len + 1);
+                const std::size_t len = static_cast<std::size_t>(byte_code::get<std::uint64_t>(iter));
+                value.assign(std::to_address(iter), len);
+                iter += static_cast<std::ptrdiff_t>(len);
             }
         }
         
@@ -645,9 +895,46 @@ template <typename K, typename V, typename ... OtherStuff> \
     //////////////////////////////////////////////////////////////////////////////////////////////
     
     struct cpp_subset_compiler {
-        std::string src;
-        std::string msg;
-        std::string out;
+        // Maps positions in a pass's out back to its src. Anchors are (out, src) offset pairs placed wherever
+        // a pass skips or rewrites text, positions between two anchors were copied one to one.
+        struct offset_map {
+            std::pmr::vector<std::pair<std::size_t, std::size_t>> anchors;
+
+            constexpr std::size_t to_source(std::size_t position) const {
+                auto it = std::upper_bound(anchors.begin(), anchors.end(), position, [](std::size_t p, const auto& a) {
+                    return p < a.first;
+                });
+                if (it == anchors.begin()) {
+                    return position;
+                }
+                --it;
+                return it->second + (position - it->first);
+            }
+        };
+
+        struct function_macro {
+            std::pmr::vector<std::string_view>  parameters;     // A variadic macro ends with __VA_ARGS__.
+            std::pmr::string                    body;
+            bool                                variadic = false;
+
+            bool operator==(const function_macro&) const = default;
+        };
+        using function_macro_map = std::pmr::unordered_map<std::string_view, function_macro>;
+
+        // Every pass reads src and writes out, so both buffers come from one resource.
+        std::pmr::string                src;
+        std::pmr::string                out;
+        std::pmr::string                origin;      // Source as given, diagnostics are located in it.
+        std::pmr::vector<offset_map>    maps;        // One per finished pass, see next_pass.
+        offset_map                      current;     // Of the pass running now.
+        std::vector<diagnostic>         diagnostics;
+        std::vector<std::size_t>        diagnostic_positions;   // In origin, one per diagnostic.
+        function_macro_map              function_macros;  // Defined by expand_conditional_macros, names view into its src.
+        std::vector<std::string>        namespaces;       // Qualified names of the namespace blocks, in order of appearance.
+
+        explicit cpp_subset_compiler(std::string_view source, std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : src(source, mr), out(mr), origin(source, mr), maps(mr), current{ std::pmr::vector<std::pair<std::size_t, std::size_t>>(mr) },
+          function_macros(mr) {}
         
         static constexpr std::string_view keywords[255] = {
             "int8_t",       "uint8_t",   "int16_t",        "uint16_t",
@@ -672,12 +959,117 @@ template <typename K, typename V, typename ... OtherStuff> \
         };
 
         constexpr operator bool() const noexcept {
-            return msg.empty();
+            return std::ranges::none_of(diagnostics, [](const auto& d) { return d.severity == severity_error; });
+        }
+
+        // Finishes the running pass, its out becomes the next pass's src.
+        void next_pass() {
+            maps.push_back(std::move(current));
+            current = offset_map{ std::pmr::vector<std::pair<std::size_t, std::size_t>>(out.get_allocator()) };
+            src = out;
+        }
+
+        // Marks that out.size() of the running pass corresponds to src_position.
+        constexpr void anchor(std::size_t src_position) {
+            current.anchors.emplace_back(out.size(), src_position);
         }
 
-        constexpr void remove_comments() noexcept {
+        // position is an offset in src, it is carried back through every finished pass to the origin.
+        void report(diagnostic_severity severity, std::size_t position, std::string_view message) {
+            for (auto m = maps.rbegin(); m != maps.rend(); ++m) {
+                position = m->to_source(position);
+            }
+            position = std::min(position, origin.size());
+
+            diagnostic d{ {}, 1, 1, severity, std::string(message) };
+            std::size_t line_begin = 0;
+            for (std::size_t next = origin.find('\n'); next != std::string_view::npos && next < position; next = origin.find('\n', line_begin)) {
+                std::string_view line(origin.data() + line_begin, next - line_begin);
+                ++d.line;
+                if (line.starts_with("#line ")) {
+                    std::size_t number = 0;
+                    auto [ptr, ec] = std::from_chars(line.data() + 6, line.data() + line.size(), number);
+                    if (ec == std::errc()) {
+                        d.line = number;
+                        if (auto q = line.find('\"'); q != std::string_view::npos) {
+                            d.file = line.substr(q + 1, line.find('\"', q + 1) - q - 1);
+                        }
+                    }
+                }
+                line_begin = next + 1;
+            }
+            d.column = position - line_begin + 1;
+            diagnostics.push_back(std::move(d));
+            diagnostic_positions.push_back(position);
+        }
+
+        // First pass, splices included files in between #line directives and makes the result the origin, so
+        // diagnostics name the included file. #pragma once becomes a guard macro, repeated includes are then
+        // skipped by expand_conditional_macros like guarded ones. An #include that can't be resolved turns
+        // into an #error, reported only when it is in an active region.
+        void include_files(include_cache& cache) {
+            auto directives = scan_include_directives(src);
+            if (std::ranges::none_of(directives, &include_directive::is_include)) {
+                return;
+            }
             out.clear();
             out.reserve(src.size());
+            std::pmr::vector<const include_cache::file*> stack(out.get_allocator());
+            splice_includes(cache, src, directives, {}, stack);
+            origin = out;
+            src    = out;
+        }
+
+        void splice_includes(include_cache& cache, std::string_view text, const std::vector<include_directive>& directives,
+            std::string_view file, std::pmr::vector<const include_cache::file*>& stack) {
+            std::size_t    copied = 0;
+            std::ptrdiff_t offset = 0;     // Line number minus the physical line, changed by #line.
+            for (const auto& d : directives) {
+                if (!d.is_include) {
+                    offset = static_cast<std::ptrdiff_t>(d.number) - static_cast<std::ptrdiff_t>(d.line + 1);
+                    file   = d.name.empty() ? file : std::string_view(d.name);
+                    continue;
+                }
+                out.append(text, copied, d.begin - copied);
+                copied = d.end;
+
+                const auto* included = cache.find(d.name, file, d.angled);
+                if (!included) {
+                    out.append(std::format("#error Can't open include file {:s}!\n", d.name));
+                    continue;
+                }
+                if (std::ranges::find(stack, included) != stack.end()) {
+                    // Already open further up, a guarded file is inactive there anyway.
+                    if (!included->once && included->guard.empty()) {
+                        out.append(std::format("#error {:s} includes itself!\n", d.name));
+                    } else {
+                        out.push_back('\n');
+                    }
+                    continue;
+                }
+                const auto once = std::format("__CPOD_ONCE_{:016x}", byte_code::hash(included->path));
+                if (included->once) {
+                    out.append(std::format("#ifndef {0:s}\n#define {0:s}\n", once));
+                }
+                out.append(std::format("#line 1 \"{:s}\"\n", included->path));
+                stack.push_back(included);
+                splice_includes(cache, included->text, included->directives, included->path, stack);
+                stack.pop_back();
+                if (!out.empty() && out.back() != '\n') {
+                    out.push_back('\n');
+                }
+                if (included->once) {
+                    out.append("#endif\n");
+                }
+                out.append(std::format("#line {:d} \"{:s}\"\n", static_cast<std::ptrdiff_t>(d.line + 1) + offset, file));
+            }
+            out.append(text, copied);
+        }
+
+        constexpr void remove_comments() {
+            out.clear();
+            out.reserve(src.size());
+            anchor(0);
             bool         is_within_raw = false;
             std::size_t  quote_count   = 0;
             for (std::size_t i = 0; i < src.length(); ++i) {
@@ -710,18 +1102,27 @@ template <typename K, typename V, typename ... OtherStuff> \
                             if (i == std::string_view::npos) {
                                 return;
                             }
+                            anchor(i + 1);
                         }
                         // Multi line comment.
                         else if (src[i + 1] == '*') {
+                            const std::size_t begin = i;
                             i = src.find("*/", i + 2);
                             if (i == std::string_view::npos) {
+                                report(severity_warning, begin, "Unterminated comment, the rest of the source is ignored.");
                                 return;
                             }
-                            i += 2;
+                            i += 1;
+                            anchor(i + 1);
                         }
                         else {
-                            msg = "Invalid character after /";
-                            return;
+                            // Division is only valid in #if expressions.
+                            const std::size_t line_begin = src.rfind('\n', i) + 1;
+                            const std::size_t first      = src.find_first_not_of(" \t", line_begin);
+                            if (src[first] != '#') {
+                                report(severity_error, i, "Invalid character after /.");
+                            }
+                            out.push_back(src[i]);
                         }
                     } else { out.push_back(src[i]); } break;
                 default: out.push_back(src[i]); break;
@@ -729,14 +1130,15 @@ template <typename K, typename V, typename ... OtherStuff> \
             }
         } // remove_comments.
         
-        // We don't need function macro since cpod doesn't support expssions.
+        // Object-like defines only, compile_content reads its defines in expand_conditional_macros.
         template <class StrAlloc, typename ... Rest>
         constexpr void get_macro_define_map(std::unordered_map<
             std::string_view,
             std::basic_string<char, std::char_traits<char>, StrAlloc>, Rest...>& macro_map) {
             out.clear();
             out.reserve(src.size());
-            for (std::size_t i = 0; i != src.size(); ++i) {
+            anchor(0);
+            for (std::size_t i = 0; i < src.size(); ++i) {
                 switch (src[i]) {
                 default: out.push_back(src[i]); break;
                 case '#': {
@@ -759,6 +1161,7 @@ template <typename K, typename V, typename ... OtherStuff> \
                         std::erase_if(macro_value, [](auto& c) { return c == '\n'; });
                         macro_map.insert(std::make_pair(macro_key, macro_value));
                         i += (l - &src[i]);
+                        anchor(i + 1);
                     } else {
                         out.push_back(src[i]);
                     }
@@ -800,104 +1203,799 @@ template <typename K, typename V, typename ... OtherStuff> \
             }
         }
 
+        // Text of a #define after its name, without line continuations and surrounding spaces.
+        template <class Alloc>
+        static constexpr std::basic_string<char, std::char_traits<char>, Alloc> macro_value(std::string_view text, const Alloc& alloc) {
+            std::basic_string<char, std::char_traits<char>, Alloc> value(text, alloc);
+            std::erase_if(value, [](auto& c) { return c == '\\' && (&c)[1] == '\n'; });
+            std::erase_if(value, [](auto& c) { return c == '\n'; });
+            const auto trimmed = value.find_first_not_of(" \t");
+            value.erase(0, std::min(trimmed, value.size()));
+            while (!value.empty() && std::isspace(static_cast<unsigned char>(value.back()))) { value.pop_back(); }
+            return value;
+        }
+
+        // text starts after the ( of #define NAME(params) body.
+        void define_function_macro(std::size_t position, std::string_view key, std::string_view text) {
+            function_macro macro{ std::pmr::vector<std::string_view>(out.get_allocator()), std::pmr::string(out.get_allocator()) };
+            std::size_t i = 0;
+            auto skip_space = [&]() {
+                while (i < text.size() && (std::isspace(static_cast<unsigned char>(text[i])) || text[i] == '\\')) { ++i; }
+            };
+            for (skip_space(); i < text.size() && text[i] != ')';) {
+                if (macro.variadic) {
+                    report(severity_error, position, std::format("... must be the last parameter of macro {:s}!", key));
+                    return;
+                }
+                if (text.substr(i, 3) == "...") {
+                    macro.parameters.push_back("__VA_ARGS__");
+                    macro.variadic = true;
+                    i += 3;
+                } else {
+                    const std::size_t begin = i;
+                    while (i < text.size() && (std::isalnum(static_cast<unsigned char>(text[i])) || text[i] == '_')) { ++i; }
+                    if (begin == i) {
+                        report(severity_error, position, std::format("Invalid parameter list of macro {:s}!", key));
+                        return;
+                    }
+                    macro.parameters.push_back(text.substr(begin, i - begin));
+                }
+                skip_space();
+                if (i < text.size() && text[i] == ',') {
+                    ++i; skip_space();
+                } else if (i < text.size() && text[i] != ')') {
+                    report(severity_error, position, std::format("Invalid parameter list of macro {:s}!", key));
+                    return;
+                }
+            }
+            if (i == text.size()) {
+                report(severity_error, position, std::format("Missing ) after parameters of macro {:s}!", key));
+                return;
+            }
+            macro.body = macro_value(text.substr(i + 1), out.get_allocator());
+            if (auto it = function_macros.find(key); it != function_macros.end()) {
+                if (it->second != macro) {
+                    report(severity_warning, position, std::format("Macro {:s} redefined!", key));
+                }
+                it->second = std::move(macro);
+            } else {
+                function_macros.emplace(key, std::move(macro));
+            }
+        }
+
+        // Value of a #if expression. Macro values like MXX_SYSTEM are string literals, those only compare with == and !=.
+        struct constant_value {
+            std::int64_t        number  = 0;
+            std::string_view    text;
+            bool                is_text = false;
+
+            constexpr constant_value() = default;
+            constexpr constant_value(std::int64_t n) : number(n) {}
+            constexpr constant_value(std::string_view t) : text(t), is_text(true) {}
+
+            constexpr bool truthy() const { return is_text ? !text.empty() : number != 0; }
+        };
+
+        // Recursive descent over one #if expression, identifiers are looked up in the macro map and parsed in turn.
+        template <class MacroMap>
+        struct constant_expression_parser {
+            const MacroMap&             macro_map;
+            const function_macro_map&   functions;
+            std::string_view            expr;
+            std::size_t                 depth;
+            std::size_t                 pos   = 0;
+            std::string                 error;
+
+            constexpr constant_expression_parser(const MacroMap& m, const function_macro_map& f, std::string_view e, std::size_t d = 0)
+                : macro_map(m), functions(f), expr(e), depth(d) {}
+
+            static constexpr std::pair<std::string_view, int> binary_operators[] = {
+                { "||", 1 }, { "&&", 2 }, { "|", 3 }, { "^", 4 }, { "&", 5 }, { "==", 6 }, { "!=", 6 },
+                { "<=", 7 }, { ">=", 7 }, { "<<", 8 }, { ">>", 8 }, { "<", 7 }, { ">", 7 },
+                { "+", 9 },  { "-", 9 },  { "*", 10 }, { "/", 10 }, { "%", 10 }
+            };
+
+            constexpr void skip_space() {
+                while (pos < expr.size() && std::isspace(static_cast<unsigned char>(expr[pos]))) { ++pos; }
+            }
+
+            constexpr bool accept(std::string_view token) {
+                skip_space();
+                if (expr.substr(pos, token.size()) == token) {
+                    pos += token.size();
+                    return true;
+                }
+                return false;
+            }
+
+            constexpr std::string_view identifier() {
+                skip_space();
+                const std::size_t begin = pos;
+                while (pos < expr.size() && (std::isalnum(static_cast<unsigned char>(expr[pos])) || expr[pos] == '_')) { ++pos; }
+                return expr.substr(begin, pos - begin);
+            }
+
+            constexpr constant_value fail(std::string message) {
+                if (error.empty()) { error = std::move(message); }
+                pos = expr.size();
+                return {};
+            }
+
+            // Parses the whole expression, anything left over is an error.
+            constexpr constant_value parse() {
+                auto value = conditional();
+                skip_space();
+                if (pos != expr.size()) {
+                    return fail(std::format("Unexpected '{:s}' in #if expression!", expr.substr(pos)));
+                }
+                return value;
+            }
+
+            constexpr constant_value conditional() {
+                auto condition = binary(1);
+                if (!accept("?")) {
+                    return condition;
+                }
+                auto if_true = conditional();
+                if (!accept(":")) {
+                    return fail("Missing : in #if expression!");
+                }
+                auto if_false = conditional();
+                return condition.truthy() ? if_true : if_false;
+            }
+
+            constexpr constant_value binary(int min_precedence) {
+                auto lhs = unary();
+                for (;;) {
+                    skip_space();
+                    auto op = std::ranges::find_if(binary_operators, [&](const auto& o) {
+                        return expr.substr(pos, o.first.size()) == o.first;
+                    });
+                    if (op == std::end(binary_operators) || op->second < min_precedence) {
+                        return lhs;
+                    }
+                    pos += op->first.size();
+                    auto rhs = binary(op->second + 1);
+                    lhs = apply(op->first, lhs, rhs);
+                }
+            }
+
+            constexpr constant_value apply(std::string_view op, const constant_value& l, const constant_value& r) {
+                if (l.is_text || r.is_text) {
+                    if (l.is_text != r.is_text) {
+                        return fail("Can't compare a string with a number in #if expression!");
+                    }
+                    if (op == "==") { return { l.text == r.text }; }
+                    if (op == "!=") { return { l.text != r.text }; }
+                    return fail(std::format("Operator {:s} is not supported on strings in #if expression!", op));
+                }
+                const std::int64_t a = l.number, b = r.number;
+                // + - * << wrap around in unsigned arithmetic, the cases that still overflow are rejected.
+                const std::uint64_t ua = static_cast<std::uint64_t>(a), ub = static_cast<std::uint64_t>(b);
+                if ((op == "/" || op == "%") && b == 0) {
+                    return fail("Division by zero in #if expression!");
+                }
+                if ((op == "/" || op == "%") && a == std::numeric_limits<std::int64_t>::min() && b == -1) {
+                    return fail("Division overflow in #if expression!");
+                }
+                if ((op == "<<" || op == ">>") && (b < 0 || b >= 64)) {
+                    return fail(std::format("Shift count {:d} is out of range in #if expression!", b));
+                }
+                if (op == "||") { return { a || b }; }
+                if (op == "&&") { return { a && b }; }
+                if (op == "|")  { return { a | b }; }
+                if (op == "^")  { return { a ^ b }; }
+                if (op == "&")  { return { a & b }; }
+                if (op == "==") { return { a == b }; }
+                if (op == "!=") { return { a != b }; }
+                if (op == "<=") { return { a <= b }; }
+                if (op == ">=") { return { a >= b }; }
+                if (op == "<<") { return { static_cast<std::int64_t>(ua << b) }; }
+                if (op == ">>") { return { a >> b }; }
+                if (op == "<")  { return { a < b }; }
+                if (op == ">")  { return { a > b }; }
+                if (op == "+")  { return { static_cast<std::int64_t>(ua + ub) }; }
+                if (op == "-")  { return { static_cast<std::int64_t>(ua - ub) }; }
+                if (op == "*")  { return { static_cast<std::int64_t>(ua * ub) }; }
+                if (op == "/")  { return { a / b }; }
+                return { a % b };
+            }
+
+            constexpr constant_value unary() {
+                skip_space();
+                if (pos == expr.size()) {
+                    return fail("Missing operand in #if expression!");
+                }
+                const char c = expr[pos];
+                if (c == '!') { ++pos; return { !unary().truthy() }; }
+                if (c == '~') { ++pos; return { ~unary().number }; }
+                if (c == '-') { ++pos; return { static_cast<std::int64_t>(0 - static_cast<std::uint64_t>(unary().number)) }; }
+                if (c == '+') { ++pos; return unary(); }
+                if (c == '(') {
+                    ++pos;
+                    auto value = conditional();
+                    if (!accept(")")) {
+                        return fail("Missing ) in #if expression!");
+                    }
+                    return value;
+                }
+                if (c == '\"') {
+                    const std::size_t end = expr.find('\"', pos + 1);
+                    if (end == std::string_view::npos) {
+                        return fail("Unmatched string quote in #if expression!");
+                    }
+                    constant_value value(expr.substr(pos + 1, end - pos - 1));
+                    pos = end + 1;
+                    return value;
+                }
+                if (std::isdigit(static_cast<unsigned char>(c))) {
+                    int base = 10;
+                    if (expr.substr(pos, 2) == "0x" || expr.substr(pos, 2) == "0X") { base = 16; pos += 2; }
+                    else if (expr.substr(pos, 2) == "0b" || expr.substr(pos, 2) == "0B") { base = 2; pos += 2; }
+                    else if (c == '0' && pos + 1 < expr.size() && std::isdigit(static_cast<unsigned char>(expr[pos + 1]))) { base = 8; ++pos; }
+                    constant_value value{};
+                    auto [ptr, ec] = std::from_chars(expr.data() + pos, expr.data() + expr.size(), value.number, base);
+                    if (ec != std::errc()) {
+                        return fail("Invalid number in #if expression!");
+                    }
+                    pos = static_cast<std::size_t>(ptr - expr.data());
+                    while (pos < expr.size() && (expr[pos] == 'u' || expr[pos] == 'U' || expr[pos] == 'l' || expr[pos] == 'L')) { ++pos; }
+                    return value;
+                }
+                const auto name = identifier();
+                if (name.empty()) {
+                    return fail(std::format("Unexpected '{:c}' in #if expression!", c));
+                }
+                if (name == "defined") {
+                    const bool parenthesized = accept("(");
+                    const auto key = identifier();
+                    if (key.empty() || (parenthesized && !accept(")"))) {
+                        return fail("Invalid defined() in #if expression!");
+                    }
+                    return { macro_map.contains(key) || functions.contains(key) };
+                }
+                if (name == "true")  { return { 1 }; }
+                if (name == "false") { return {}; }
+                // Like C, an unknown identifier is 0.
+                auto it = macro_map.find(name);
+                if (it == macro_map.end()) {
+                    return {};
+                }
+                if (depth == 32) {
+                    return fail(std::format("Macro {:s} expands recursively in #if expression!", name));
+                }
+                constant_expression_parser nested{ macro_map, functions, it->second, depth + 1 };
+                auto value = nested.parse();
+                if (!nested.error.empty()) {
+                    return fail(std::move(nested.error));
+                }
+                return value;
+            }
+        };
+
+        // Runs #if/#ifdef/#ifndef/#elif/#else/#endif with a stack, and #define/#undef of active regions in order.
+        // Inactive lines are only scanned for the next directive. Macro keys view into src, keep it alive while
+        // macro_map is in use. Every other directive line is dropped.
         template <class StrAlloc, typename ... Rest>
         constexpr void expand_conditional_macros(std::unordered_map<
             std::string_view,
             std::basic_string<char, std::char_traits<char>, StrAlloc>, Rest...>& macro_map) {
             out.clear();
             out.reserve(src.size());
+            anchor(0);
+
+            struct frame {
+                std::size_t  position;
+                bool         parent_active;
+                bool         taken;         // Some branch of this #if was active already.
+                bool         active;
+                bool         seen_else;
+            };
+            std::pmr::vector<frame> stack(out.get_allocator());
+            auto active   = [&]() { return stack.empty() || stack.back().active; };
+            auto defined  = [&](std::string_view key) { return macro_map.contains(key) || function_macros.contains(key); };
+            auto evaluate = [&](std::size_t position, std::string_view expression) {
+                constant_expression_parser<std::remove_cvref_t<decltype(macro_map)>> parser{ macro_map, function_macros, expression };
+                auto value = parser.parse();
+                if (!parser.error.empty()) {
+                    report(severity_error, position, parser.error);
+                    return false;
+                }
+                return value.truthy();
+            };
+
+            bool resumed = true;
+            for (std::size_t i = 0; i < src.size();) {
+                const std::size_t first = src.find_first_not_of(" \t", i);
+                if (first == std::string_view::npos || src[first] != '#') {
+                    std::size_t eol = src.find('\n', i);
+                    eol = eol == std::string_view::npos ? src.size() : eol + 1;
+                    if (active()) {
+                        if (!resumed) { anchor(i); resumed = true; }
+                        out.append(src, i, eol - i);
+                    }
+                    i = eol;
+                    continue;
+                }
 
-            bool is_inside_check_scope = false;
-            bool is_ifdef              = false;
-            bool is_defined            = false;
+                // Directive, lines ending with a backslash continue it.
+                std::size_t eol = src.find('\n', first);
+                while (eol != std::string_view::npos && src[eol - 1] == '\\') {
+                    eol = src.find('\n', eol + 1);
+                }
+                eol = eol == std::string_view::npos ? src.size() : eol;
+                std::size_t name_begin = src.find_first_not_of(" \t", first + 1);
+                name_begin = std::min(name_begin, eol);
+                std::size_t name_end = name_begin;
+                while (name_end < eol && std::isalpha(static_cast<unsigned char>(src[name_end]))) { ++name_end; }
+                const std::string_view name(src.data() + name_begin, name_end - name_begin);
+                std::string_view       rest(src.data() + name_end, eol - name_end);
+                while (!rest.empty() && std::isspace(static_cast<unsigned char>(rest.front()))) { rest.remove_prefix(1); }
+                const std::string_view key = rest.substr(0, std::ranges::find_if(rest, [](char c) {
+                    return !std::isalnum(static_cast<unsigned char>(c)) && c != '_';
+                }) - rest.begin());
+
+                if (name == "if" || name == "ifdef" || name == "ifndef") {
+                    const bool parent = active();
+                    bool condition = false;
+                    if (parent) {
+                        if (name == "if")         { condition = evaluate(first, rest); }
+                        else if (key.empty())     { report(severity_error, first, std::format("Missing macro name after #{:s}!", name)); }
+                        else                      { condition = defined(key) == (name == "ifdef"); }
+                    }
+                    stack.push_back({ first, parent, condition, condition, false });
+                }
+                else if (name == "elif" || name == "elifdef" || name == "elifndef" || name == "else") {
+                    if (stack.empty()) {
+                        report(severity_error, first, std::format("#{:s} without #if!", name));
+                    }
+                    else if (stack.back().seen_else) {
+                        report(severity_error, first, std::format("#{:s} after #else!", name));
+                    }
+                    else {
+                        auto& f = stack.back();
+                        bool condition = false;
+                        if (f.parent_active && !f.taken) {
+                            if (name == "else")        { condition = true; }
+                            else if (name == "elif")   { condition = evaluate(first, rest); }
+                            else                       { condition = defined(key) == (name == "elifdef"); }
+                        }
+                        f.active    = condition;
+                        f.taken     = f.taken || condition;
+                        f.seen_else = name == "else";
+                    }
+                }
+                else if (name == "endif") {
+                    if (stack.empty()) {
+                        report(severity_error, first, "#endif without #if!");
+                    } else {
+                        stack.pop_back();
+                    }
+                }
+                else if (name == "define" && active()) {
+                    if (key.empty()) {
+                        report(severity_error, first, "Missing macro name after #define!");
+                    }
+                    // Function-like when ( follows the name directly.
+                    else if (rest.size() > key.size() && rest[key.size()] == '(') {
+                        define_function_macro(first, key, rest.substr(key.size() + 1));
+                        macro_map.erase(key);
+                    }
+                    else {
+                        auto value = macro_value(rest.substr(key.size()), StrAlloc(macro_map.get_allocator()));
+                        function_macros.erase(key);
+                        if (auto it = macro_map.find(key); it != macro_map.end()) {
+                            if (it->second != value) {
+                                report(severity_warning, first, std::format("Macro {:s} redefined!", key));
+                            }
+                            it->second = std::move(value);
+                        } else {
+                            macro_map.emplace(key, std::move(value));
+                        }
+                    }
+                }
+                else if (name == "undef" && active()) {
+                    macro_map.erase(key);
+                    function_macros.erase(key);
+                }
+                else if ((name == "error" || name == "warning") && active()) {
+                    report(name == "error" ? severity_error : severity_warning, first, rest);
+                }
+                i = eol + 1;
+                resumed = false;
+            }
+            for (const auto& f : stack) {
+                report(severity_error, f.position, "Unterminated #if, missing #endif!");
+            }
+        }
 
-            for (auto it = src.begin(); it != src.end(); ++it) {
-                switch (*it) {
-                default:
-                    if (!is_inside_check_scope || (is_inside_check_scope && is_ifdef == is_defined)) {
-                        out.push_back(*it);
-                    } break;
-                case '#': {
-                    auto j = std::find_if_not(it + 1, src.end(), [](auto& c) { return std::isspace(c); });
-                    auto k = std::find_if(j, src.end(), [](auto& c) { return std::isspace(c); });
-                    std::string_view cmd(&*j, k - j);
-                    if (cmd == "ifdef" || cmd == "ifndef") {
-                        j = std::find_if_not(k, src.end(), [](auto& c) { return std::isspace(c); });
-                        k = std::find_if(j, src.end(), [](auto& c) { return std::isspace(c); });
-                        std::string_view key(&*j, k - j);
-                        is_inside_check_scope = true;
-                        is_ifdef              = cmd == "ifdef";
-                        is_defined            = macro_map.contains(key);
-                    }
-                    else if (cmd == "endif") {
-                        is_inside_check_scope = false;
-                        is_defined            = false;
-                        is_ifdef              = false;
-                    }
-                    k = std::find(k, src.end(), '\n');
-                    it = k;
-                    if (it == src.end()) {
-                        --it;
+        // Preprocessing token, text views into the source, a macro body or macro_expander::spellings.
+        struct pp_token {
+            std::string_view  text;
+            std::string_view  leading;    // Whitespace before the token.
+            std::size_t       position;   // In src, tokens from an expansion take the position of the macro name.
+            std::uint32_t     hide;       // Hide set, macros that must not expand this token again.
+            bool              generated;  // Produced by an expansion.
+        };
+
+        static constexpr bool is_identifier_char(char c) {
+            return std::isalnum(static_cast<unsigned char>(c)) || c == '_' || c == ':';
+        }
+
+        // Splits text into identifiers, numbers, string literals, ## and single characters.
+        static constexpr void lex(std::string_view text, std::pmr::vector<pp_token>& tokens) {
+            for (std::size_t i = 0; i < text.size();) {
+                const std::size_t space = i;
+                while (i < text.size() && (std::isspace(static_cast<unsigned char>(text[i])) || (text[i] == '\\' && i + 1 < text.size() && text[i + 1] == '\n'))) {
+                    i += text[i] == '\\' ? 2 : 1;
+                }
+                if (i >= text.size()) {
+                    break;
+                }
+                const std::size_t begin = i;
+                const char        c     = text[i];
+                if (text.substr(i, 3) == "R\"(") {
+                    const std::size_t end = text.find(")\"", i + 3);
+                    i = end == std::string_view::npos ? text.size() : end + 2;
+                }
+                else if (std::isalpha(static_cast<unsigned char>(c)) || c == '_') {
+                    while (i < text.size() && is_identifier_char(text[i])) { ++i; }
+                }
+                else if (std::isdigit(static_cast<unsigned char>(c))) {
+                    for (++i; i < text.size(); ++i) {
+                        const bool exponent_sign = (text[i] == '+' || text[i] == '-') && std::string_view("eEpP").find(text[i - 1]) != std::string_view::npos;
+                        if (!std::isalnum(static_cast<unsigned char>(text[i])) && text[i] != '.' && text[i] != '_' && !exponent_sign) {
+                            break;
+                        }
                     }
-                } break;
                 }
+                else if (c == '\"') {
+                    // An unmatched quote ends at the line end, normalize_string_literals reports it.
+                    for (++i; i < text.size() && text[i] != '\"' && text[i] != '\n'; ++i) {
+                        if (text[i] == '\\') { ++i; }
+                    }
+                    i = std::min(text.size(), i + (i < text.size() && text[i] == '\"'));
+                }
+                else {
+                    i += text.substr(i, 2) == "##" ? 2 : 1;
+                }
+                tokens.push_back({ text.substr(begin, i - begin), text.substr(space, begin - space), begin, 0, false });
             }
         }
 
+        // Expands macros on the token stream. A token carries the hide set of the macros it came from, so
+        // rescanning stops without string rescans. Hide sets are interned and their unions and intersections
+        // memoized, an object-like macro found in the source is expanded once and its tokens reused.
+        template <class MacroMap>
+        struct macro_expander {
+            cpp_subset_compiler&                                    compiler;
+            const MacroMap&                                         macro_map;
+            std::pmr::memory_resource*                              resource;
+            std::pmr::unordered_map<std::string_view, std::uint32_t> ids;
+            std::pmr::deque<std::pmr::vector<pp_token>>             bodies;         // Lexed body by macro id, stable while growing.
+            std::pmr::vector<const function_macro*>                 functions;      // By macro id, null when object-like.
+            std::pmr::vector<std::uint32_t>                         singletons;     // Hide set of just the macro by id.
+            std::pmr::vector<std::pmr::vector<std::uint32_t>>       hide_sets;      // Sorted macro ids, 0 is empty.
+            std::pmr::unordered_map<std::uint64_t, std::uint32_t>   unions;
+            std::pmr::unordered_map<std::uint64_t, std::uint32_t>   intersections;
+            std::pmr::unordered_map<std::uint32_t, std::pmr::vector<pp_token>> memo;
+            std::pmr::deque<std::pmr::string>                       spellings;      // Pasted and stringized tokens.
+
+            macro_expander(cpp_subset_compiler& c, const MacroMap& m, std::pmr::memory_resource* mr)
+                : compiler(c), macro_map(m), resource(mr), ids(mr), bodies(mr), functions(mr), singletons(mr),
+                  hide_sets(1, std::pmr::vector<std::uint32_t>(mr), mr), unions(mr), intersections(mr), memo(mr), spellings(mr) {}
+
+            // Id of the macro named text, or -1.
+            constexpr std::uint32_t find(std::string_view text) {
+                if (auto it = ids.find(text); it != ids.end()) {
+                    return it->second;
+                }
+                const function_macro* function = nullptr;
+                std::string_view      name, body;
+                if (auto it = macro_map.find(text); it != macro_map.end()) {
+                    name = it->first; body = it->second;
+                } else if (auto f = compiler.function_macros.find(text); f != compiler.function_macros.end()) {
+                    name = f->first; body = f->second.body; function = &f->second;
+                } else {
+                    return static_cast<std::uint32_t>(-1);
+                }
+                const auto id = static_cast<std::uint32_t>(bodies.size());
+                ids.emplace(name, id);
+                lex(body, bodies.emplace_back());
+                functions.push_back(function);
+                hide_sets.emplace_back(1, id);
+                singletons.push_back(static_cast<std::uint32_t>(hide_sets.size() - 1));
+                return id;
+            }
+
+            constexpr bool hides(std::uint32_t set, std::uint32_t id) const {
+                return std::ranges::binary_search(hide_sets[set], id);
+            }
+
+            template <bool Union>
+            constexpr std::uint32_t combine(std::uint32_t a, std::uint32_t b) {
+                if (a == b || (Union ? b == 0 : a == 0)) { return a; }
+                if (Union ? a == 0 : b == 0)             { return b; }
+                auto& cache = Union ? unions : intersections;
+                auto [it, inserted] = cache.try_emplace((std::uint64_t(std::min(a, b)) << 32) | std::max(a, b), 0);
+                if (inserted) {
+                    std::pmr::vector<std::uint32_t> set(resource);
+                    if constexpr (Union) {
+                        std::ranges::set_union(hide_sets[a], hide_sets[b], std::back_inserter(set));
+                    } else {
+                        std::ranges::set_intersection(hide_sets[a], hide_sets[b], std::back_inserter(set));
+                    }
+                    it->second = static_cast<std::uint32_t>(hide_sets.size());
+                    hide_sets.push_back(std::move(set));
+                }
+                return it->second;
+            }
+
+            constexpr bool is_pending_function(const pp_token& token) {
+                const auto id = find(token.text);
+                return id != static_cast<std::uint32_t>(-1) && functions[id] && !hides(token.hide, id);
+            }
+
+            // #parameter, whitespace between tokens becomes one space, quotes and backslashes of literals are escaped.
+            constexpr pp_token stringize(std::span<const pp_token> argument) {
+                auto& text = spellings.emplace_back();
+                text.push_back('\"');
+                for (const auto& token : argument) {
+                    if (&token != argument.data() && !token.leading.empty()) {
+                        text.push_back(' ');
+                    }
+                    const bool literal = token.text.starts_with('\"') || token.text.starts_with("R\"");
+                    for (char c : token.text) {
+                        if (literal && (c == '\"' || c == '\\')) {
+                            text.push_back('\\');
+                        }
+                        text.push_back(c);
+                    }
+                }
+                text.push_back('\"');
+                return { text, {}, 0, 0, true };
+            }
+
+            // Replaces the parameters in the body of macro id, pasting with ##, and appends the result to to.
+            constexpr void substitute(std::uint32_t id, const std::pmr::vector<std::pmr::vector<pp_token>>& arguments,
+                std::uint32_t hide, const pp_token& invocation, std::pmr::vector<pp_token>& to) {
+                const auto& body     = bodies[id];
+                const auto* function = functions[id];
+                auto parameter = [&](std::string_view text) {
+                    if (function) {
+                        auto it = std::ranges::find(function->parameters, text);
+                        if (it != function->parameters.end()) {
+                            return static_cast<std::size_t>(it - function->parameters.begin());
+                        }
+                    }
+                    return std::string_view::npos;
+                };
+
+                const std::size_t begin    = to.size();
+                bool              produced = false;
+                for (std::size_t i = 0; i < body.size(); ++i) {
+                    const std::size_t before = to.size();
+                    const auto&       token  = body[i];
+                    std::size_t       p      = std::string_view::npos;
+                    if (function && token.text == "#" && i + 1 < body.size() && (p = parameter(body[i + 1].text)) != std::string_view::npos) {
+                        to.push_back(stringize(arguments[p]));
+                        to.back().leading = token.leading;
+                        ++i;
+                    }
+                    else if (token.text == "##") {
+                        if (i == 0 || i + 1 == body.size()) {
+                            compiler.report(severity_error, invocation.position, std::format("## can't be at either end of macro {:s}!", invocation.text));
+                            continue;
+                        }
+                        ++i;
+                        std::span<const pp_token> rhs(&body[i], 1);
+                        if ((p = parameter(body[i].text)) != std::string_view::npos) {
+                            rhs = arguments[p];
+                        }
+                        if (rhs.empty()) {
+                            continue;
+                        }
+                        if (produced) {
+                            auto& text = spellings.emplace_back(to.back().text);
+                            text.append(rhs.front().text);
+                            to.back().text = text;
+                            rhs = rhs.subspan(1);
+                        }
+                        to.insert(to.end(), rhs.begin(), rhs.end());
+                        produced = true;
+                        continue;
+                    }
+                    else if ((p = parameter(token.text)) != std::string_view::npos) {
+                        // Operands of ## are not expanded, other arguments are expanded before substitution.
+                        if (i + 1 < body.size() && body[i + 1].text == "##") {
+                            to.insert(to.end(), arguments[p].begin(), arguments[p].end());
+                        } else {
+                            expand(arguments[p], to, false);
+                        }
+                        if (to.size() != before) {
+                            to[before].leading = token.leading;
+                        }
+                    }
+                    else {
+                        to.push_back(token);
+                    }
+                    produced = to.size() != before;
+                }
+
+                for (std::size_t i = begin; i < to.size(); ++i) {
+                    auto& token     = to[i];
+                    token.hide      = combine<true>(token.hide, hide);
+                    token.position  = invocation.position;
+                    token.generated = true;
+                    token.leading   = i == begin ? invocation.leading : token.leading.empty() ? "" : " ";
+                }
+            }
+
+            // Expands input into output. Returns false when a function-like macro runs out of tokens before its ),
+            // which is reported unless isolated, an isolated expansion may continue with tokens that follow it.
+            constexpr bool expand(std::span<const pp_token> input, std::pmr::vector<pp_token>& output, bool isolated) {
+                bool                        complete = true;
+                std::pmr::vector<pp_token>  stack(input.rbegin(), input.rend(), resource);
+                std::pmr::vector<pp_token>  expansion(resource);
+                while (!stack.empty()) {
+                    const pp_token token = stack.back();
+                    stack.pop_back();
+                    const auto id = find(token.text);
+                    if (id == static_cast<std::uint32_t>(-1) || hides(token.hide, id)) {
+                        output.push_back(token);
+                        continue;
+                    }
+
+                    expansion.clear();
+                    if (!functions[id]) {
+                        if (token.hide != 0) {
+                            substitute(id, {}, combine<true>(token.hide, singletons[id]), token, expansion);
+                            stack.insert(stack.end(), expansion.rbegin(), expansion.rend());
+                            continue;
+                        }
+                        auto it = memo.find(id);
+                        if (it == memo.end()) {
+                            pp_token name = token;
+                            name.leading  = {};
+                            substitute(id, {}, singletons[id], name, expansion);
+                            std::pmr::vector<pp_token> expanded(resource);
+                            if (!expand(expansion, expanded, true)) {
+                                stack.insert(stack.end(), expansion.rbegin(), expansion.rend());
+                                stack.back().leading = token.leading;
+                                continue;
+                            }
+                            it = memo.emplace(id, std::move(expanded)).first;
+                            expansion.clear();
+                        }
+                        // A trailing function-like macro may take its arguments from the tokens after.
+                        auto& target = !it->second.empty() && is_pending_function(it->second.back()) ? expansion : output;
+                        const std::size_t begin = target.size();
+                        target.insert(target.end(), it->second.begin(), it->second.end());
+                        for (std::size_t i = begin; i < target.size(); ++i) {
+                            target[i].position = token.position;
+                        }
+                        if (begin != target.size()) {
+                            target[begin].leading = token.leading;
+                        }
+                        stack.insert(stack.end(), expansion.rbegin(), expansion.rend());
+                        continue;
+                    }
+
+                    const auto& function = *functions[id];
+                    if (stack.empty() || stack.back().text != "(") {
+                        output.push_back(token);
+                        continue;
+                    }
+                    std::pmr::vector<pp_token>                  consumed(resource);
+                    std::pmr::vector<std::pmr::vector<pp_token>> arguments(1, std::pmr::vector<pp_token>(resource), resource);
+                    std::size_t                                  level = 0;
+                    bool                                         closed = false;
+                    for (consumed.push_back(stack.back()), stack.pop_back(); !stack.empty() && !closed;) {
+                        const pp_token& next = consumed.emplace_back(stack.back());
+                        stack.pop_back();
+                        if (next.text == ")" && level == 0) {
+                            closed = true;
+                            continue;
+                        }
+                        level += next.text == "(";
+                        level -= next.text == ")";
+                        if (next.text == "," && level == 0 && !(function.variadic && arguments.size() == function.parameters.size())) {
+                            arguments.emplace_back();
+                        } else {
+                            arguments.back().push_back(next);
+                        }
+                    }
+                    if (!closed) {
+                        if (!isolated) {
+                            compiler.report(severity_error, token.position, std::format("Unterminated arguments of macro {:s}!", token.text));
+                        }
+                        complete = false;
+                        output.push_back(token);
+                        output.insert(output.end(), consumed.begin(), consumed.end());
+                        continue;
+                    }
+                    if (function.parameters.empty() && arguments.size() == 1 && arguments.front().empty()) {
+                        arguments.clear();
+                    }
+                    if (function.variadic && arguments.size() + 1 == function.parameters.size()) {
+                        arguments.emplace_back();
+                    }
+                    if (arguments.size() != function.parameters.size()) {
+                        compiler.report(severity_error, token.position, std::format("Macro {:s} takes {:d} arguments, but {:d} given!",
+                            token.text, function.parameters.size(), arguments.size()));
+                        continue;
+                    }
+                    const auto hide = combine<true>(combine<false>(token.hide, consumed.back().hide), singletons[id]);
+                    substitute(id, arguments, hide, token, expansion);
+                    stack.insert(stack.end(), expansion.rbegin(), expansion.rend());
+                }
+                return complete;
+            }
+        };
+
+        // Expands macros, function-like macros take their arguments from the tokens after them.
+        // Text between tokens is kept, so newlines and positions of the source survive.
         template <class StrAlloc, typename ... Rest>
         constexpr void replace_remove_macros(const std::unordered_map<
             std::string_view,
             std::basic_string<char, std::char_traits<char>, StrAlloc>, Rest...>& macro_map) {
             out.clear();
             out.reserve(src.size());
-            for (std::size_t i = 0; i != src.size(); ++i) {
-                switch (src[i]) {
-                default: out.push_back(src[i]); break;
-                case 'a': case 'b': case 'c': case 'd': case 'e': case 'f':
-                case 'g': case 'h': case 'i': case 'j': case 'k': case 'l':
-                case 'm': case 'n': case 'o': case 'p': case 'q': case 's':
-                case 't': case 'u': case 'v': case 'w': case 'x': case 'y': case 'z':
-                case 'A': case 'B': case 'C': case 'D': case 'E': case 'F':
-                case 'G': case 'H': case 'I': case 'J': case 'K': case 'L':
-                case 'M': case 'N': case 'O': case 'P': case 'Q': case 'S':
-                case 'T': case 'U': case 'V': case 'W': case 'X': case 'Y': case 'Z':
-                case '_': {
-                    char* k = &src[i];
-                    k = std::find_if_not(&src[i], &src[src.length()], [](auto& c) { return std::isalnum(c) || std::isdigit(c) || c == ':' || c == '_'; });
-                    std::string_view key(&src[i], k - &src[i]);
-                    if (macro_map.contains(key)) {
-                        out.append(macro_map.at(key));
-                    } else {
-                        out.append(key);
+            anchor(0);
+
+            std::pmr::vector<pp_token> tokens(out.get_allocator()), expanded(out.get_allocator());
+            lex(src, tokens);
+            macro_expander<std::remove_cvref_t<decltype(macro_map)>> expander(*this, macro_map, out.get_allocator().resource());
+            expander.expand(tokens, expanded, false);
+
+            bool contiguous = true;
+            for (const auto& token : expanded) {
+                if (token.generated) {
+                    out.append(token.leading);
+                    anchor(token.position);
+                } else {
+                    if (!contiguous) {
+                        anchor(token.position - token.leading.size());
                     }
-                    i += k - &src[i] - 1;
-                } break;
+                    out.append(token.leading);
                 }
+                out.append(token.text);
+                contiguous = !token.generated;
             }
+            const std::size_t tail = tokens.empty() ? 0 : tokens.back().position + tokens.back().text.size();
+            anchor(tail);
+            out.append(src, tail);
         }
 
         // Change all escape characters to their original forms.
         // And all string literals will be raw string (with R prefix) after this method call.
-        constexpr void normalize_string_literals() noexcept {
+        constexpr void normalize_string_literals() {
             out.clear();
             out.reserve(src.size());
+            anchor(0);
             for (std::size_t i = 0; i != src.length(); ++i) {
                 switch (src[i]) {
                 case 'R':
                     if (src[i + 1] == '\"' && src[i + 2] == '(') {
                         std::size_t j = src.find(")\"", i + 3);
                         if (j == std::string_view::npos) {
-                            msg = "Unmatched raw string literals!";
+                            report(severity_error, i, "Unmatched raw string literals!");
                             return;
                         }
+                        anchor(i + 1);
                         out.append(std::string_view(src.data() + i + 1, j + 1 - i));
                         i = j + 1;
+                    } else {
+                        out.push_back(src[i]);
                     } break;
                 case '\"': {
                     // Doesn't support multiline string.
+                    const std::size_t string_begin = out.size();
                     std::size_t j = i + 1;
+                    anchor(i);
                     out.append("\"(");
-                    for (; j != src.length() && (src[j] != '\"' || src[j - 1] == '\\'); ++j) {
+                    anchor(j);
+                    for (; j != src.length() && src[j] != '\n' && src[j] != '\"'; ++j) {
                         if (src[j] == '\\') {
                             switch (src[j + 1]) {
                             case 'n':  out.push_back('\n'); break;
@@ -910,19 +2008,28 @@ template <typename K, typename V, typename ... OtherStuff> \
                             case '\\': out.push_back('\\'); break;
                             case '\'': out.push_back('\''); break;
                             default:
-                                msg = "Invalid escape character!";
-                                return;
+                                report(severity_error, j, "Invalid escape character!");
+                                out.push_back(src[j + 1]); break;
                             }
                             ++j;
+                            anchor(j + 1);
                         } else {
                             out.push_back(src[j]);
                         }
                     }
-                    if (j == src.length()) {
-                        msg = "Unmatched string quote!";
-                        return;
+                    if (j == src.length() || src[j] == '\n') {
+                        // Close it at the line end so the lines after still compile.
+                        report(severity_error, i, "Unmatched string quote!");
+                        out.resize(string_begin);
+                        anchor(i);
+                        out.append("\"()\"");
+                        anchor(j);
+                        i = j - 1;
+                        break;
                     }
+                    anchor(j);
                     out.append(")\"");
+                    anchor(j + 1);
                     i = j;
                 } break;
                 default:
@@ -931,22 +2038,24 @@ template <typename K, typename V, typename ... OtherStuff> \
             } // for loop
         } // normalize_string
 
-        constexpr void combine_string_literals() noexcept {
+        constexpr void combine_string_literals() {
             out.clear();
             out.reserve(src.size());
+            anchor(0);
             for (std::size_t i = 0; i != src.size(); ++i) {
                 switch (src[i]) {
                 default:  out.push_back(src[i]); break;
                 case ')':
                     if (src[i + 1] == '\"') {
-                        std::size_t j = src.find("\"(", i + 2);
-                        std::size_t k = src.find_first_of(";,}", i + 2);
-                        if (k < j || j == std::string_view::npos) {
+                        // Only literals separated by nothing but whitespace are joined.
+                        std::size_t j = src.find_first_not_of(" \t\r\n", i + 2);
+                        if (j != std::string_view::npos && src[j] == '\"' && src[j + 1] == '(') {
+                            i = j + 1;
+                            anchor(i + 1);
+                        } else {
                             out.push_back(src[i]);
                             out.push_back(src[i + 1]);
-                            i = k - 1;
-                        } else {
-                            i = j + 1;
+                            ++i;
                         }
                     } else {
                         out.push_back(src[i]);
@@ -957,7 +2066,7 @@ template <typename K, typename V, typename ... OtherStuff> \
 
         // This step must after remove comment and normalize string.
         template <typename Iter>
-        constexpr void tokenize_source(Iter it) noexcept {
+        constexpr void tokenize_source(Iter it) {
             for (std::size_t i = 0; i < src.length(); ++i) {
                 if (std::isspace(src[i])) {
                     auto p = std::find_if_not(&src[i], &src[src.length()], [](auto& c) {
@@ -1001,8 +2110,7 @@ template <typename K, typename V, typename ... OtherStuff> \
                     *it++ = std::string_view(&src[j], p - &src[j] + 1);
                 }
                 else {
-                    msg = "Invalid character!";
-                    return;
+                    report(severity_error, i, std::format("Invalid character '{:c}'!", src[i]));
                 }
             } // for loop.
         } // tokenize_source.
@@ -1040,12 +2148,11 @@ template <typename K, typename V, typename ... OtherStuff> \
             return Ty{};
         }
         
-        static constexpr void compile_basic_type_to_buffer(std::string_view type, std::string_view value, std::string& buf) {
+        static constexpr void compile_basic_type_to_buffer(std::string_view type, std::string_view value, std::pmr::string& buf) {
     #define DEFINE_COMPILE_FIXED_VALUE(t)                             \
         do {                                                          \
         if (type == #t) {                                             \
-            const auto v = compile_basic_value<t>(value);             \
-            buf.append(reinterpret_cast<const char*>(&v), sizeof(v)); \
+            byte_code::put(buf, compile_basic_value<t>(value));       \
             return;                                                   \
         }} while(false)                                               
             DEFINE_COMPILE_FIXED_VALUE(int8_t);
@@ -1062,8 +2169,8 @@ template <typename K, typename V, typename ... OtherStuff> \
     #undef DEFINE_COMPILE_FIXED_VALUE
             // String requires special handling.
             if (type == "std::string") {
+                byte_code::put(buf, static_cast<std::uint64_t>(value.length() - 4));
                 buf.append(value.data() + 2, value.length() - 4);
-                buf.push_back('\0');
             }
         }
 
@@ -1079,7 +2186,7 @@ template <typename K, typename V, typename ... OtherStuff> \
         }
 
         template <class Iter>
-        constexpr auto compile_values_recursively(Iter ttb, Iter tte, Iter vtb, Iter vte, std::string& buf) {
+        constexpr auto compile_values_recursively(Iter ttb, Iter tte, Iter vtb, Iter vte, std::pmr::string& buf) {
             // Means basic type -- recursive end scenario.
             const std::size_t tid = std::find(std::begin(keywords), std::end(keywords), *ttb) - std::begin(keywords) + 1;
             if (tid < 13) {
@@ -1092,69 +2199,81 @@ template <typename K, typename V, typename ... OtherStuff> \
                 tte = find_matching_bracket<'<', '>'>(std::next(ttb), tte);
                 vte = find_matching_bracket<'{', '}'>(vtb, vte);
                 ttb = std::next(ttb, 2);
-                std::string cache;
-                std::size_t n = 0;
-                // Branch recursion.
-                switch(tid) {
+                std::uint64_t n = 0;
+                // Elements go straight into buf, resizable containers patch their count slot afterwards.
+                std::size_t   count_at = 0;
+                if (tid < 26) {
+                    byte_code::put(buf, n);
+                    count_at = buf.size() - sizeof(n);
+                }
+                // Branch recursion, an empty {} leaves n at 0.
+                if (std::next(vtb) != vte) switch(tid) {
                 default: break;
                 // Sequential containers (not map nor pair && tuple && array)
                 case 13: case 14: case 15: case 16: case 17: case 18: case 19: case 20: case 21:
                     for (auto k = vtb; k != vte; ++n) {
-                        k = compile_values_recursively(ttb, tte, std::next(k), vte, cache).second;
-                    }
-                    buf.append(reinterpret_cast<const char*>(&n), sizeof(n)); break;
+                        k = compile_values_recursively(ttb, tte, std::next(k), vte, buf).second;
+                    } break;
                 // Mapping containers 
                 case 22: case 23: case 24: case 25:
                     for (auto k = vtb; k != vte; ++n) {
-                        auto p1 = compile_values_recursively(ttb, tte, std::next(k, 2), vte, cache);
-                        auto p2 = compile_values_recursively(std::next(p1.first), tte, std::next(p1.second), vte, cache);
+                        auto p1 = compile_values_recursively(ttb, tte, std::next(k, 2), vte, buf);
+                        auto p2 = compile_values_recursively(std::next(p1.first), tte, std::next(p1.second), vte, buf);
                         k = std::next(p2.second);
-                    }
-                    buf.append(reinterpret_cast<const char*>(&n), sizeof(n)); break;
+                    } break;
                 // std::pair;
                 case 26: {
-                    auto p1 = compile_values_recursively(ttb, tte, std::next(vtb), vte, cache);
-                    auto p2 = compile_values_recursively(std::next(p1.first), tte, std::next(p1.second), vte, cache); } break;
+                    auto p1 = compile_values_recursively(ttb, tte, std::next(vtb), vte, buf);
+                    compile_values_recursively(std::next(p1.first), tte, std::next(p1.second), vte, buf); } break;
                 // std::array
                 case 27:
                     // The only difference between sequential containers is this do not write n into the buffer.
                     for (auto k = vtb; k != vte;) {
-                        k = compile_values_recursively(ttb, tte, std::next(k), vte, cache).second;
+                        k = compile_values_recursively(ttb, tte, std::next(k), vte, buf).second;
                     } break;
                 // std::tuple.
                 case 28:
                     for (Iter k = vtb, l = ttb;k != vte && l != tte;) {
-                        auto c = compile_values_recursively(l, tte, std::next(k), vte, cache);
+                        auto c = compile_values_recursively(l, tte, std::next(k), vte, buf);
                         l = std::next(c.first);
                         k = c.second;
                     } break;
                 }
-                // Common operation that writes cache to the buffer and move forward iterator.
-                buf.append(cache);
+                if (tid < 26) {
+                    std::memcpy(buf.data() + count_at, &n, sizeof(n));
+                }
                 return std::make_pair(std::next(tte), std::next(vte));
             }
             if (tid == 29 || tid == 30) {
+                // Members follow a hash of their names in source order, so readers can tell a block
+                // that does not list the fields they expect.
+                std::uint64_t fields = byte_code::hash({});
+                byte_code::put(buf, fields);
+                const std::size_t fields_at = buf.size() - sizeof(fields);
                 ttb = std::next(ttb, 3);
                 for (auto k = ttb; k != vte; ++k) {
                     if (*k != "struct" && *k != "class") {
                         auto assign = std::find(k, vte, "=");
                         auto semico = std::find(assign, vte, ";");
+                        fields = byte_code::hash(std::string_view("", 1), byte_code::hash(*std::prev(assign), fields));
                         compile_values_recursively(k, std::prev(assign), std::next(assign), semico, buf);
                         k = semico;
                     } else {
                         auto h = find_matching_bracket<'{','}'>(std::next(k, 2), vte);
+                        fields = byte_code::hash(std::string_view("", 1), byte_code::hash(*std::next(h), fields));
                         compile_values_recursively(k, std::next(k, 2), std::next(k, 2),h, buf);
                         k = std::next(h, 2);
                     }
                 }
+                std::memcpy(buf.data() + fields_at, &fields, sizeof(fields));
                 return std::make_pair(std::next(tte), std::next(vte));
             }
             return std::make_pair(std::next(tte), std::next(vte));
         }
 
         template <class Iter>
-        static constexpr std::string compile_type_name(Iter ttb, Iter tte) {
-            std::string buf;
+        constexpr std::pmr::string compile_type_name(Iter ttb, Iter tte) {
+            std::pmr::string buf(out.get_allocator());
             for (auto it = ttb; it != tte; ++it) {
                 if      (*it == ",") { buf.push_back(','); }
                 else if (*it == "<") { buf.push_back('<'); }
@@ -1164,9 +2283,9 @@ template <typename K, typename V, typename ... OtherStuff> \
                     if (std::all_of(it->begin(), it->end(), [](auto& c) {
                         return std::isdigit(static_cast<int>(c));
                     })) {
-                        std::size_t n = 0;
+                        std::uint64_t n = 0;
                         std::from_chars(&*it->begin(), (&*it->rbegin()) + 1, n);
-                        buf.append(reinterpret_cast<const char*>(&n), sizeof(std::size_t));
+                        buf.append(reinterpret_cast<const char*>(&n), sizeof(std::uint64_t));
                     } else {
                         const std::uint8_t t = static_cast<std::uint8_t>(std::find(std::begin(keywords), std::end(keywords), *it) - std::begin(keywords)) + 1;
                         buf.push_back(*reinterpret_cast<const char*>(&t));
@@ -1181,11 +2300,50 @@ template <typename K, typename V, typename ... OtherStuff> \
         constexpr void generate_byte_code(const Container& tokens) {
             out.clear();
             out.reserve(tokens.size());
+            byte_code::put_header(out);
+            generate_records(tokens);
+            // Records before an error stay readable, the end mark is always written.
+            byte_code::put(out, std::uint64_t{ 0 });
+        } // Generate byte code.
+
+        constexpr std::size_t token_position(std::string_view token) const {
+            return static_cast<std::size_t>(token.data() - src.data());
+        }
+
+        // Variables in namespace a { namespace b { ... } } are recorded as a::b::name.
+        template <class Container>
+        constexpr void generate_records(const Container& tokens) {
+            std::pmr::string                                    scope(out.get_allocator());   // "a::b::" of the open namespaces.
+            std::pmr::vector<std::pair<std::size_t, std::size_t>> open(out.get_allocator());  // Scope size before and position of each.
             for (auto t = tokens.begin(); t != tokens.end(); ++t) {
+                if (*t == "namespace") {
+                    auto name = std::next(t);
+                    if (name == tokens.end() || std::next(name) == tokens.end() || *std::next(name) != "{" ||
+                        !(std::isalpha(static_cast<unsigned char>(name->front())) || name->front() == '_')) {
+                        report(severity_error, token_position(*t), "Expected a name and { after namespace.");
+                        return;
+                    }
+                    open.emplace_back(scope.size(), token_position(*t));
+                    scope.append(*name).append("::");
+                    if (std::string qualified(scope.data(), scope.size() - 2); std::ranges::find(namespaces, qualified) == namespaces.end()) {
+                        namespaces.push_back(std::move(qualified));
+                    }
+                    t = std::next(name);
+                    continue;
+                }
+                if (*t == "}") {
+                    if (open.empty()) {
+                        report(severity_error, token_position(*t), "Unmatched }.");
+                        continue;
+                    }
+                    scope.resize(open.back().first);
+                    open.pop_back();
+                    continue;
+                }
                 if (auto i = std::find(std::begin(keywords), std::end(keywords), *t); i != std::end(keywords)) {
-                    std::string              value_cache;
-                    std::string              variable_name_cache;
-                    std::string              type_cache;
+                    std::pmr::string         value_cache(out.get_allocator());
+                    std::pmr::string         variable_name_cache(out.get_allocator());
+                    std::pmr::string         type_cache(out.get_allocator());
                     decltype(tokens.end())   semicolumn;
                     
                     if (*t == "struct" || *t == "class") {
@@ -1193,40 +2351,56 @@ template <typename K, typename V, typename ... OtherStuff> \
                         type_cache.append(*std::next(t));
                         type_cache.push_back('\0');
                         auto struct_end = find_matching_bracket<'{', '}'>(std::next(t, 2), tokens.end());
-                        variable_name_cache = *std::next(struct_end);
+                        variable_name_cache = scope;
+                        variable_name_cache.append(*std::next(struct_end));
                         variable_name_cache.push_back('\0');
                         semicolumn = std::next(struct_end, 2); 
                         compile_values_recursively(t, std::next(t, 2), std::next(t, 2), struct_end, value_cache);
                     }
                     else {
-                        auto assign = std::find(t, tokens.end(), "=");
-                        if (assign == tokens.end()) {
-                            msg = "Missing assign operator (=).";
-                            return;
+                        auto statement_end = std::find(t, tokens.end(), ";");
+                        auto assign        = std::find(t, statement_end, "=");
+                        if (assign == statement_end) {
+                            report(severity_error, token_position(*t), "Missing assign operator (=).");
+                            // Resume at the next statement.
+                            if (statement_end == tokens.end()) {
+                                return;
+                            }
+                            t = statement_end;
+                            continue;
                         }
-                        semicolumn = std::find(assign, tokens.end(), ";");
+                        semicolumn = statement_end;
                         if (semicolumn == tokens.end()) {
-                            msg = "Missing ; after expression.";
+                            report(severity_error, token_position(*std::prev(semicolumn)), "Missing ; after expression.");
                             return;
                         }
                         type_cache = compile_type_name(t, std::prev(assign));
-                        variable_name_cache = *std::prev(assign);
+                        variable_name_cache = scope;
+                        variable_name_cache.append(*std::prev(assign));
                         variable_name_cache.push_back('\0');
                         compile_values_recursively(t, std::prev(assign), std::next(assign), semicolumn, value_cache);
                         t = semicolumn;
                     }
                     
                     t = semicolumn;
-                    const std::size_t offset = type_cache.size() + variable_name_cache.size() + value_cache.size();
-                    out.append(reinterpret_cast<const char*>(&offset), sizeof(std::size_t));
+                    // Value starts 8 byte aligned, so its alignment relative to value_cache holds in out too.
+                    const std::size_t head = type_cache.size() + variable_name_cache.size();
+                    variable_name_cache.append((byte_code::record_align - head % byte_code::record_align) % byte_code::record_align, '\0');
+                    byte_code::pad(value_cache, byte_code::record_align);
+                    const std::uint64_t key    = byte_code::hash(std::string_view(variable_name_cache.data(), variable_name_cache.find('\0') + 1),
+                                                                 byte_code::hash(type_cache));
+                    const std::uint64_t offset = sizeof(key) + type_cache.size() + variable_name_cache.size() + value_cache.size();
+                    byte_code::put(out, offset);
+                    byte_code::put(out, key);
                     out.append(type_cache);
                     out.append(variable_name_cache);
                     out.append(value_cache);
                 }
             } // for loop
-            constexpr std::size_t end_mark = 0;
-            out.append(reinterpret_cast<const char*>(&end_mark), sizeof(std::size_t));
-        } // Generate byte code.
+            if (!open.empty()) {
+                report(severity_error, open.back().second, "Unterminated namespace, missing }.");
+            }
+        } // Generate records.
     };
 
     //////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1235,54 +2409,225 @@ template <typename K, typename V, typename ... OtherStuff> \
     
     template <class Ty>
     constexpr std::string::const_iterator archive::find_variable_begin(std::string_view var_name) {
-        // Search tag.
-        std::string type_and_name;
-        if constexpr (std_type<Ty>) {
-            type_and_name = std_type_name_string<Ty>(true);
-        } else {
-            type_and_name = structure_type_name_string<Ty>();
-        }
-        type_and_name.append(var_name).push_back('\0');
+        // Search tag, the signature part is a compile time constant.
+        using signature = details::binary_signature<Ty>;
+        const std::uint64_t key = byte_code::hash(std::string_view("", 1), byte_code::hash(var_name, signature::key));
         // Skip-field variable checking & searching method.
-        auto offset_block = content_.cbegin();
-        for (std::size_t
-            offset = *reinterpret_cast<const std::size_t*>(&*offset_block);
+        byte_code::check_header(content_);
+        auto offset_block = content_.cbegin() + byte_code::header_size;
+        for (std::uint64_t
+            offset = byte_code::get<std::uint64_t>(offset_block);
             offset != 0;
-            offset = *reinterpret_cast<const std::size_t*>(&*offset_block)) {
+            offset = byte_code::get<std::uint64_t>(offset_block)) {
             // A very weird technique I developed. 
-            offset_block += sizeof(std::size_t);
-            if (std::equal(type_and_name.cbegin(), type_and_name.cend(), offset_block)) {
-                return offset_block + type_and_name.size();
+            auto record = offset_block;
+            if (byte_code::get<std::uint64_t>(record) == key
+             && std::equal(signature::view.cbegin(), signature::view.cend(), record)
+             && std::equal(var_name.cbegin(), var_name.cend(), record + static_cast<std::ptrdiff_t>(signature::size))
+             && *(record + static_cast<std::ptrdiff_t>(signature::size + var_name.size())) == '\0') {
+                record += static_cast<std::ptrdiff_t>(signature::size + var_name.size() + 1);
+                byte_code::align(record, byte_code::record_align);
+                return record;
             }
-            offset_block += static_cast<std::size_t>(offset);
+            offset_block += static_cast<std::ptrdiff_t>(offset);
         }
         return content_.cend();
     }
     
-    inline std::string archive::compile_content_default(const std::unordered_map<std::string_view, std::string>& init_macro_map) noexcept {
-        cpp_subset_compiler compiler(std::move(content_));
-        std::vector<std::string_view>                     token_list;
-        std::unordered_map<std::string_view, std::string> macro_map = init_macro_map;
+    inline std::vector<include_directive> scan_include_directives(std::string_view text) {
+        std::vector<include_directive> directives;
+        std::size_t line = 1;
+        for (std::size_t begin = 0; begin < text.size(); ++line) {
+            std::size_t end = text.find('\n', begin);
+            end = end == std::string_view::npos ? text.size() : end + 1;
+            std::string_view rest = text.substr(begin, end - begin);
+            rest.remove_prefix(std::min(rest.find_first_not_of(" \t"), rest.size()));
+            if (rest.starts_with('#')) {
+                rest.remove_prefix(std::min(rest.find_first_not_of(" \t", 1), rest.size()));
+                include_directive d{ begin, end, line, rest.starts_with("include"), false, 0, {} };
+                if (d.is_include || rest.starts_with("line")) {
+                    rest.remove_prefix(d.is_include ? 7 : 4);
+                    rest.remove_prefix(std::min(rest.find_first_not_of(" \t"), rest.size()));
+                    std::errc ec{};
+                    if (!d.is_include) {
+                        const auto result = std::from_chars(rest.data(), rest.data() + rest.size(), d.number);
+                        ec = result.ec;
+                        rest.remove_prefix(result.ptr - rest.data());
+                        rest.remove_prefix(std::min(rest.find_first_not_of(" \t"), rest.size()));
+                    }
+                    d.angled = rest.starts_with('<');
+                    if (rest.starts_with('\"') || d.angled) {
+                        const std::size_t close = rest.find(d.angled ? '>' : '\"', 1);
+                        d.name = rest.substr(1, (close == std::string_view::npos ? rest.size() : close) - 1);
+                    }
+                    if (d.is_include || ec == std::errc{}) {
+                        directives.push_back(std::move(d));
+                    }
+                }
+            }
+            begin = end;
+        }
+        return directives;
+    }
 
-        compiler.remove_comments(); compiler.src = compiler.out;             
-        compiler.get_macro_define_map(macro_map);
-        std::string out_source = std::move(compiler.src);
+    inline const include_cache::file* include_cache::find(std::string_view name, std::string_view including_file, bool angled) {
+        std::vector<std::filesystem::path> candidates;
+        if (!angled) {
+            candidates.push_back(std::filesystem::path(including_file).parent_path() / name);
+        }
+        for (const auto& directory : directories_) {
+            candidates.push_back(std::filesystem::path(directory) / name);
+        }
 
-        
-        for (auto& i : macro_map) {
-            cpp_subset_compiler::expand_macro_value(macro_map, i.first);
+        std::lock_guard lock(mutex_);
+        for (const auto& candidate : candidates) {
+            auto [it, inserted] = files_.try_emplace(candidate.lexically_normal().generic_string());
+            if (inserted) {
+                std::ifstream ifs(it->first, std::ios::binary);
+                if (!ifs.good()) {
+                    continue;
+                }
+                auto f  = std::make_unique<file>();
+                f->path = it->first;
+                f->text.assign(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+                f->directives = scan_include_directives(f->text);
+
+                // The guard is an #ifndef G, #define G first and its #endif last, with only blank and // lines around.
+                std::size_t depth = 0, count = 0;
+                bool        outside = false, closed = false;
+                std::string candidate_guard;
+                std::istringstream lines(f->text);
+                for (std::string line; std::getline(lines, line);) {
+                    std::string_view l(line);
+                    l.remove_prefix(std::min(l.find_first_not_of(" \t\r"), l.size()));
+                    if (l.empty() || l.starts_with("//")) {
+                        continue;
+                    }
+                    if (!l.starts_with('#')) {
+                        outside = outside || depth == 0;
+                        continue;
+                    }
+                    l.remove_prefix(std::min(l.find_first_not_of(" \t", 1), l.size()));
+                    auto word = [&]() {
+                        auto w = l.substr(0, std::min(l.find_first_of(" \t\r("), l.size()));
+                        l.remove_prefix(w.size());
+                        l.remove_prefix(std::min(l.find_first_not_of(" \t"), l.size()));
+                        return w;
+                    };
+                    const auto directive = word();
+                    const auto argument  = word();
+                    f->once = f->once || (directive == "pragma" && argument == "once");
+                    if (++count == 1) {
+                        if (directive == "ifndef" && !outside) {
+                            candidate_guard = argument;
+                        }
+                    } else if (count == 2 && !(directive == "define" && argument == candidate_guard)) {
+                        candidate_guard.clear();
+                    }
+                    if (directive == "if" || directive == "ifdef" || directive == "ifndef") {
+                        outside = outside || closed;
+                        ++depth;
+                    } else if (directive == "endif" && depth != 0 && --depth == 0) {
+                        outside = outside || closed;
+                        closed  = true;
+                    } else if (depth == 0) {
+                        outside = true;
+                    }
+                }
+                if (!outside && count >= 2) {
+                    f->guard = std::move(candidate_guard);
+                }
+                it->second = std::move(f);
+            }
+            if (it->second) {
+                return it->second.get();
+            }
         }
-        
-        compiler.src = compiler.out; compiler.expand_conditional_macros(macro_map);
-        compiler.src = compiler.out; compiler.replace_remove_macros(macro_map);
-        compiler.src = compiler.out; compiler.normalize_string_literals();
-        compiler.src = compiler.out; compiler.combine_string_literals();
-        compiler.src = compiler.out;
+        return nullptr;
+    }
+
+    struct archive::section {
+        archive                   arch;
+        std::vector<diagnostic>   diagnostics;
+        std::vector<std::string>  namespaces;    // Qualified names of its namespace blocks.
+    };
+
+    inline void archive::compile_many(std::span<section> sections, const std::unordered_map<std::string_view, std::string>& init_macro_map,
+                                      std::size_t thread_count, include_cache* includes, std::pmr::memory_resource* upstream) {
+        include_cache local_includes;
+        if (!includes) {
+            includes = &local_includes;
+        }
+        std::atomic<std::size_t> next = 0;
+        auto worker = [&]() {
+            std::pmr::unsynchronized_pool_resource arena(upstream);
+            for (std::size_t i; (i = next.fetch_add(1)) < sections.size();) {
+                auto& arch     = sections[i].arch;
+                auto  resource = std::exchange(arch.resource_, &arena);
+                sections[i].diagnostics = arch.compile_content(init_macro_map, includes, &sections[i].namespaces);
+                arch.resource_ = resource;
+            }
+        };
+        if (thread_count == 0) {
+            thread_count = std::max(1u, std::thread::hardware_concurrency());
+        }
+        thread_count = std::min(thread_count, sections.size());
+        std::vector<std::thread> threads;
+        for (std::size_t i = 1; i < thread_count; ++i) {
+            threads.emplace_back(worker);
+        }
+        worker();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    inline std::vector<diagnostic> archive::compile_content(const std::unordered_map<std::string_view, std::string>& init_macro_map,
+                                                            include_cache* includes, std::vector<std::string>* namespaces) noexcept {
+        include_cache local_includes;
+        cpp_subset_compiler compiler(content_, resource_);
+        std::pmr::vector<std::string_view>                          token_list(resource_);
+        std::pmr::unordered_map<std::string_view, std::pmr::string> macro_map(resource_);
+        for (auto& [key, val] : init_macro_map) {
+            macro_map.emplace(key, val);
+        }
+
+        compiler.include_files(includes ? *includes : local_includes);
+        compiler.remove_comments(); compiler.next_pass();
+        compiler.expand_conditional_macros(macro_map);
+        // Macro keys view into this buffer, keep it alive until byte code is generated.
+        std::pmr::string out_source = std::move(compiler.src);
+
+        compiler.next_pass(); compiler.replace_remove_macros(macro_map);
+        compiler.next_pass(); compiler.normalize_string_literals();
+        compiler.next_pass(); compiler.combine_string_literals();
+        compiler.next_pass();
         
         compiler.tokenize_source(std::back_inserter(token_list));
         compiler.generate_byte_code(token_list);
-        content_ = compiler.out;
-        return std::move(compiler.msg);
+        content_.assign(compiler.out);
+        if (namespaces) {
+            *namespaces = std::move(compiler.namespaces);
+        }
+        // Passes report in their own order, list them as they appear in the source.
+        std::vector<std::size_t> order(compiler.diagnostics.size());
+        std::iota(order.begin(), order.end(), std::size_t{ 0 });
+        std::ranges::stable_sort(order, {}, [&](std::size_t i) { return compiler.diagnostic_positions[i]; });
+        std::vector<diagnostic> diagnostics;
+        diagnostics.reserve(order.size());
+        for (std::size_t i : order) {
+            diagnostics.push_back(std::move(compiler.diagnostics[i]));
+        }
+        return diagnostics;
+    }
+
+    inline std::string archive::compile_content_default(const std::unordered_map<std::string_view, std::string>& init_macro_map,
+                                                        include_cache* includes) noexcept {
+        std::string messages;
+        for (const auto& d : compile_content(init_macro_map, includes)) {
+            messages.append(to_string(d)).push_back('\n');
+        }
+        return messages;
     }
 
     //////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -1320,6 +2665,137 @@ template <typename K, typename V, typename ... OtherStuff> \
         }
     };
 
+    namespace details {
+        // Splits the stringized field list of CPOD_REFLECT, "a, b, c", into its names.
+        template <std::size_t N>
+        constexpr std::array<std::string_view, N> split_field_names(std::string_view list) {
+            std::array<std::string_view, N> names{};
+            for (std::size_t i = 0; i != N; ++i) {
+                const auto comma = list.find(',');
+                auto       field = list.substr(0, comma);
+                while (!field.empty() && field.front() == ' ') { field.remove_prefix(1); }
+                while (!field.empty() && field.back()  == ' ') { field.remove_suffix(1); }
+                names[i] = field;
+                list = comma == std::string_view::npos ? std::string_view{} : list.substr(comma + 1);
+            }
+            return names;
+        }
+
+        // Variable templates so they are only instantiated once serializer<Ty> is complete.
+        template <class Ty>
+        inline constexpr std::size_t reflected_field_count = std::tuple_size_v<decltype(serializer<Ty>::fields(std::declval<Ty&>()))>;
+
+        template <class Ty>
+        inline constexpr auto reflected_field_names = split_field_names<reflected_field_count<Ty>>(serializer<Ty>::field_names);
+
+        // Same hash the compiler puts in front of a struct block whose members are listed in this order.
+        template <class Ty>
+        inline constexpr std::uint64_t reflected_field_signature = [] {
+            std::uint64_t h = byte_code::hash({});
+            for (auto name : reflected_field_names<Ty>) {
+                h = byte_code::hash(std::string_view("", 1), byte_code::hash(name, h));
+            }
+            return h;
+        }();
+    }
+
+    // Base of the serializer CPOD_REFLECT generates, Ty's fields come from serializer<Ty>::fields.
+    template <class Ty>
+    struct reflected_serializer {
+        template <class Self>
+        static constexpr auto field_tuple(Self& value) {
+            return serializer<Ty>::fields(value);
+        }
+
+        constexpr void operator()(archive& arch, std::string_view name, const Ty& v, flag_t flag) {
+            auto_structure_description_writer<Ty> writer(arch, name);
+            write_fields(arch, field_tuple(v), flag, std::make_index_sequence<details::reflected_field_count<Ty>>{});
+        }
+        // Field values are stored in source order without names, so this is a single pass once the
+        // block's field hash shows the source listed exactly the reflected fields in the same order.
+        constexpr void operator()(std::string::const_iterator& mem_begin, Ty& v, flag_t flag) {
+            if (byte_code::get<std::uint64_t>(mem_begin) != details::reflected_field_signature<Ty>) {
+                throw std::invalid_argument(std::string("Fields of struct ").append(serializer<Ty>::type_name)
+                    .append(" in the byte code do not match the CPOD_REFLECT list in name or order!"));
+            }
+            std::apply([&](auto& ... field) { (read_field(mem_begin, field, flag), ...); }, field_tuple(v));
+        }
+
+    private:
+        template <class Tuple, std::size_t ... I>
+        static constexpr void write_fields(archive& arch, const Tuple& fields, flag_t flag, std::index_sequence<I...>) {
+            constexpr auto& names = details::reflected_field_names<Ty>;
+            ((serializer<std::remove_cvref_t<std::tuple_element_t<I, Tuple>>>{}(arch, names[I], std::get<I>(fields), flag), arch << '\n'), ...);
+        }
+
+        template <class Field>
+        static constexpr void read_field(std::string::const_iterator& mem_begin, Field& field, flag_t flag) {
+            if constexpr (std_type<Field>) {
+                std_basic_type_binary_input_reader reader{flag};
+                details::iterate_std_template_stuff_impl<Field>{}(mem_begin, reader, field, 0);
+            } else {
+                serializer<Field>{}(mem_begin, field, flag);
+            }
+        }
+    };
+
+// Field list helpers of CPOD_REFLECT, up to 32 fields. CPOD_REFLECT_EXPAND_ keeps MSVC's
+// traditional preprocessor from passing __VA_ARGS__ on as a single argument.
+#define CPOD_REFLECT_EXPAND_(x) x
+#define CPOD_REFLECT_CONCAT_(a, b) CPOD_REFLECT_CONCAT_IMPL_(a, b)
+#define CPOD_REFLECT_CONCAT_IMPL_(a, b) a##b
+#define CPOD_REFLECT_COUNT_(...) CPOD_REFLECT_EXPAND_(CPOD_REFLECT_COUNT_IMPL_(__VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1))
+#define CPOD_REFLECT_COUNT_IMPL_(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
+#define CPOD_REFLECT_MEMBERS_(value, ...) CPOD_REFLECT_EXPAND_(CPOD_REFLECT_CONCAT_(CPOD_REFLECT_MEMBERS_, CPOD_REFLECT_COUNT_(__VA_ARGS__))(value, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_1(v, a) v.a
+#define CPOD_REFLECT_MEMBERS_2(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_1(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_3(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_2(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_4(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_3(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_5(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_4(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_6(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_5(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_7(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_6(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_8(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_7(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_9(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_8(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_10(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_9(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_11(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_10(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_12(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_11(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_13(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_12(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_14(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_13(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_15(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_14(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_16(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_15(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_17(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_16(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_18(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_17(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_19(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_18(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_20(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_19(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_21(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_20(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_22(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_21(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_23(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_22(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_24(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_23(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_25(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_24(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_26(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_25(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_27(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_26(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_28(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_27(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_29(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_28(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_30(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_29(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_31(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_30(v, __VA_ARGS__))
+#define CPOD_REFLECT_MEMBERS_32(v, a, ...) v.a, CPOD_REFLECT_EXPAND_(CPOD_REFLECT_MEMBERS_31(v, __VA_ARGS__))
+
+// Generates cpod::serializer<Type> for an aggregate. List every non-static data member, fields are
+// stored in list order and a struct block written in another order fails to read. Each value is taken by member name, so a misspelled member does not compile,
+// and the structured binding only checks that the list has as many distinct names as Type has members.
+// Use at global scope.
+#define CPOD_REFLECT(Type, ...)                                                         \
+template <>                                                                             \
+struct cpod::serializer<Type> : cpod::reflected_serializer<Type> {                      \
+    static constexpr std::string_view type_name   = #Type;                              \
+    static constexpr std::string_view field_names = #__VA_ARGS__;                       \
+    template <class Self>                                                               \
+    static constexpr auto fields(Self& value) {                                         \
+        [[maybe_unused]] auto& [__VA_ARGS__] = value;                                   \
+        return std::tie(CPOD_REFLECT_MEMBERS_(value, __VA_ARGS__));                     \
+    }                                                                                   \
+}
+
     template <class Ty>
     constexpr auto std_text_value_of(const Ty& value) {
         std_basic_type_text_output_formatter formatter{0};
@@ -6,6 +6,16 @@
 #include <fstream>
 #include <filesystem>
 #include <cstdlib>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <chrono>
+#include <random>
+#include <array>
+#include <bit>
+#include <unordered_set>
+#include <limits>
+#include <charconv>
 
 #include "cpod.hpp"
 #include "makeplusplus.hpp"
@@ -56,6 +66,16 @@ namespace makexx {
 #define MXX_OPTIMIZATION_2   3
 #define MXX_OPTIMIZATION_3   4
 
+#define MXX_ISA_SSE2         1
+#define MXX_ISA_AVX          2
+#define MXX_ISA_AVX2         3
+#define MXX_ISA_AVX512       4
+#define MXX_ISA_NATIVE       5
+
+#define MXX_PGO_NONE         1
+#define MXX_PGO_INSTRUMENT   2
+#define MXX_PGO_OPTIMIZE     3
+
 #define MXX_MSVC_SUBSYSTEM_CONSOLE 1
 #define MXX_MSVC_SUBSYSTEM_WINDOW  2
 
@@ -70,6 +90,9 @@ namespace makexx {
 #define TARGET_EXTERNAL_LINKS                  std::vector<std::string> mxx_target_external_links
 #define TARGET_EXTERNAL_LINK_DIRECTORIES       std::vector<std::string> mxx_target_external_link_directories  
 #define TARGET_EXTERNAL_INCLUDE_DIRECTORIES    std::vector<std::string> mxx_target_external_include_directories
+#define TARGET_PUBLIC_INCLUDE_DIRECTORIES      std::vector<std::string> mxx_target_public_include_directories
+#define TARGET_PUBLIC_DEFINES                  std::vector<std::string> mxx_target_public_defines
+#define TARGET_PUBLIC_EXTERNAL_LINKS           std::vector<std::string> mxx_target_public_external_links
 
 #define TARGET_BINARY_DIRECTORY                std::string              mxx_target_binary_directory
 #define TARGET_INTERMEDIATE_DIRECTORY          std::string              mxx_target_intermediate_directory
@@ -78,9 +101,20 @@ namespace makexx {
 #define TARGET_STD_CPP                         uint32_t                 mxx_target_std_cpp
 #define TARGET_STD_C                           uint32_t                 mxx_target_std_c
 #define TARGET_OPTIMIZATION                    uint32_t                 mxx_target_optimization
+#define TARGET_INSTRUCTION_SET                 uint32_t                 mxx_target_instruction_set
+#define TARGET_LTO                             bool                     mxx_target_lto
+#define TARGET_PGO_PHASE                       uint32_t                 mxx_target_pgo_phase
+
+#define TARGET_UNITY_BUILD                     uint32_t                 mxx_target_unity_build
+#define TARGET_PCH_HEADER                      std::string              mxx_target_pch_header
+#define TARGET_PCH_SOURCE                      std::string              mxx_target_pch_source
 
 #define TARGET_MSVC_ICON                       std::string              mxx_target_msvc_icon
 #define TARGET_MSVC_SUBSYSTEM                  uint32_t                 mxx_target_msvc_subsystem
+#define TARGET_MSVC_MULTIPROCESSOR             uint32_t                 mxx_target_msvc_multiprocessor
+#define TARGET_MSVC_CODEGEN_THREADS            uint32_t                 mxx_target_msvc_codegen_threads
+#define TARGET_MSVC_INCREMENTAL_LINK           bool                     mxx_target_msvc_incremental_link
+#define TARGET_MSVC_DEBUG_FASTLINK             bool                     mxx_target_msvc_debug_fastlink
 )" ;
         arch.content().append(generated_header_default);
     }
@@ -110,7 +144,7 @@ namespace makexx {
             "#define MXX_SYSTEM MXX_SYSTEM_LINUX\n"
 #else
             "#define MXX_SYSTEM_REAL_UNIX \"unix\"\n"
-            "#define MXX_SYSTEM MXX_SYSTEM_UNIX\n"
+            "#define MXX_SYSTEM MXX_SYSTEM_REAL_UNIX\n"
 #endif
             ;
         arch.content().append(std::format(generated_plat_header, current_path));
@@ -121,12 +155,13 @@ namespace makexx {
         return arch.content();
     }
 
-    static void get_header_archive_from_buffer(cpod::archive& arch, std::unordered_map<std::string_view, std::string>& defmap) {
-        cpod::cpp_subset_compiler compiler(std::move(arch.content()));
+    static void get_header_archive_from_buffer(cpod::archive& arch, std::pmr::string& holder, std::unordered_map<std::string_view, std::string>& defmap) {
+        cpod::cpp_subset_compiler compiler(arch.content(), holder.get_allocator().resource());
 
         compiler.remove_comments(); compiler.src = compiler.out;             
         compiler.get_macro_define_map(defmap);
-        arch.content() = std::move(compiler.src);
+        // Keys of defmap view into compiler.src, same resource so the move keeps the storage.
+        holder = std::move(compiler.src);
 
         for (auto& i : defmap) {
             cpod::cpp_subset_compiler::expand_macro_value(defmap, i.first);
@@ -163,20 +198,18 @@ namespace makexx {
             return result;
         }
 
-        static void                  xml_save_map_to_file(std::unordered_map<std::string_view, xmloxx::tree>& map, std::string_view ext, std::string_view rootdir = "") {
-            for (auto& [target_name, tree] : map) {
-                std::ofstream map_file((std::filesystem::path(rootdir) / (std::string(target_name) + std::string(ext))).lexically_normal());
-                auto s = tree.to_string();
-                map_file.rdbuf()->sputn(s.data(), s.size());
-            }
+        static void                  xml_save_to_file(const xmloxx::tree& tree, std::string_view target_name, std::string_view ext, std::string_view rootdir = "") {
+            std::ofstream map_file((std::filesystem::path(rootdir) / (std::string(target_name) + std::string(ext))).lexically_normal());
+            auto s = tree.to_string();
+            map_file.rdbuf()->sputn(s.data(), s.size());
         }
         
+        // Seeded once, projects made in the same second must still get distinct GUIDs for dependencies to resolve.
         static std::string generate_guid() {
-            std::srand(static_cast<unsigned int>(std::time(nullptr)));
-            unsigned int r = std::rand();
-            return std::format("{{{:08X}-{:04X}-{:04X}-{:04X}-{:08X}{:04X}}}",
-                r % 0xFFFFFFFF, r % 0xFFFF, r % 0xFFFF, r % 0xFFFF,
-                r % 0xFFFFFFFF, r % 0xFFFF);
+            static std::mt19937_64 engine{ std::random_device{}() };
+            std::uint64_t hi = engine(), lo = engine();
+            return std::format("{{{:08X}-{:04X}-{:04X}-{:04X}-{:012X}}}",
+                hi >> 32, (hi >> 16) & 0xFFFF, hi & 0xFFFF, lo >> 48, lo & 0xFFFFFFFFFFFFull);
         }
 
         static const char* get_project_type_string(target_types type) {
@@ -204,19 +237,69 @@ namespace makexx {
             return optimizations[static_cast<std::uint32_t>(op)];
         }
 
-        static xmloxx::tree::iterator find_item_definition_group_element(xmloxx::tree& tree, std::string_view condition, std::string_view subrange) {
-            return tree.find_first_child_with_name(
-                tree.find_first_sibling_with_attribute(
-                tree.find_nth_sibling(tree.begin() + 1, 12), "Condition", condition), subrange);
+        // Top level layout written by new_target with n configs:
+        // ItemGroup, Globals, Import, n * Configuration, Import, 2 * ImportGroup, n * PropertySheets,
+        // UserMacros, n * PropertyGroup (OutDir/IntDir), n * ItemDefinitionGroup, ...
+        static constexpr std::size_t configuration_group_index(std::size_t i) {
+            return 3 + i;
+        }
+
+        static constexpr std::size_t property_group_index(std::size_t n, std::size_t i) {
+            return 7 + 2 * n + i;
+        }
+
+        static constexpr std::size_t item_definition_group_index(std::size_t n, std::size_t i) {
+            return 7 + 3 * n + i;
+        }
+
+        // MSVC has no -march=native counterpart, native leaves the compiler default.
+        static const char* get_instruction_set_string(target_instruction_sets isa) {
+            static constexpr const char* isas[] = { "", "StreamingSIMDExtensions2", "AdvancedVectorExtensions",
+                "AdvancedVectorExtensions2", "AdvancedVectorExtensions512", "" };
+            return isas[static_cast<std::uint32_t>(isa)];
+        }
+
+        static const char* get_pgo_link_string(target_pgo_phases phase) {
+            static constexpr const char* phases[] = { "", "", "PGInstrument", "PGOptimization" };
+            return phases[static_cast<std::uint32_t>(phase)];
+        }
+
+        static xmloxx::tree::iterator find_item_definition_group_element(xmloxx::tree& tree, std::size_t n, std::size_t i, std::string_view subrange) {
+            return tree.find_first_child_with_name(tree.find_nth_sibling(tree.begin() + 1, item_definition_group_index(n, i)), subrange);
         }
         
-        static auto  extract_config(std::string_view config) {
-            std::size_t      split = config.find('_');
-            std::string      mode(config.substr(split + 1));
-            std::string      plat(config.substr(0, split));
-            std::string      tag  = std::format("{:s}|{:s}", mode, plat);
-            std::string      comb = std::format("'$(Configuration)|$(Platform)'=='{:s}'",tag);
-            return std::make_tuple(mode, plat, tag, comb);
+        // Walks the filter trie one path component at a time, every prefix seen for the first time
+        // gets its Filter node, so parents are always written before their children.
+        static void push_filter_hierarchy(xmloxx::tree& tree_filter, visual_studio_project::filter_cache& cache, std::string_view filter) {
+            std::size_t node = 0;
+            for (std::size_t begin = 0, end = 0; begin < filter.size(); begin = end + 1) {
+                end = std::min(filter.find('\\', begin), filter.size());
+                std::string_view component = filter.substr(begin, end - begin);
+                if (component.empty()) {
+                    continue;
+                }
+                if (auto it = cache.filter_trie[node].find(component); it != cache.filter_trie[node].end()) {
+                    node = it->second;
+                    continue;
+                }
+                cache.filter_trie[node].emplace(component, cache.filter_trie.size());
+                node = cache.filter_trie.size();
+                cache.filter_trie.emplace_back();
+                tree_filter.push_node("UniqueIdentifier",
+                    tree_filter.push_node("Filter", tree_filter.begin() + 2)->push_attribute("Include", filter.substr(0, end)))->text(generate_guid());
+            }
+        }
+
+        static visual_studio_project::config_descriptor make_config_descriptor(std::string_view config) {
+            std::size_t                              split = config.find('_');
+            visual_studio_project::config_descriptor desc;
+            desc.name       = config;
+            desc.mode       = config.substr(split + 1);
+            desc.platform   = config.substr(0, split);
+            desc.tag        = std::format("{:s}|{:s}", desc.mode, desc.platform);
+            desc.condition  = std::format("'$(Configuration)|$(Platform)'=='{:s}'", desc.tag);
+            desc.mode_upper = normalize_to_uppercase_mode(desc.mode);
+            return desc;
         }
 
         static void  generate_resource(std::string_view target_name, std::string_view iconname) {
@@ -307,64 +390,118 @@ IDI_ICON1               ICON                    "{1:s}"
     //     Header and Sources only have little differences.    //
     /////////////////////////////////////////////////////////////
     
-    static void target_attach_files_(xmloxx::tree& tree_filter, xmloxx::tree& tree_proj,
+    static void target_attach_files_(xmloxx::tree& tree_filter, xmloxx::tree& tree_proj, visual_studio_project::filter_cache& cache,
         const std::vector<std::string>& files, const std::string& filter_root, int type) {
         
         static const char* item_strings[] = { "", "ClInclude", "ClCompile", "Image", "ResourceCompile" };
         // Add filter to list.
         auto  item_group_file_filter = tree_filter.find_nth_sibling_with_name(tree_filter.begin() + 2, type); // The second child is the first item group.
+        auto  item_group_file_proj   = tree_proj.find_nth_sibling_with_name(tree_proj.begin() + 1, type);
+        auto& directories            = cache.directories[filter_root];
         
         std::string absrt =  std::filesystem::absolute(std::filesystem::path(filter_root).lexically_normal()).generic_string();
 
-#define GET_ABS_PATH(abspath)\
-auto abspath = std::filesystem::absolute(std::filesystem::path(path).lexically_normal()).remove_filename().generic_string();\
-abspath.erase(0, absrt.size());\
-abspath = msvc_details::get_filter_path(abspath);\
-if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
-        
         for (auto& path : files) {
-            GET_ABS_PATH(abspath)
-            if (!abspath.empty()) {
-                // vcxproj_filter_name_map_[abspath] = abspath;
-                tree_filter.push_node("UniqueIdentifier",
-                    tree_filter.push_node("Filter",tree_filter.begin() + 2)->push_attribute("Include", abspath))->text(msvc_details::generate_guid());
+            // Files in the same raw directory share one filter, only the first one pays for path resolution.
+            std::string_view dir(path.data(), path.find_last_of("/\\") + 1);
+            auto             it = directories.find(dir);
+            if (it == directories.end()) {
+                auto abspath = std::filesystem::absolute(std::filesystem::path(path).lexically_normal()).remove_filename().generic_string();
+                abspath.erase(0, absrt.size());
+                abspath = msvc_details::get_filter_path(abspath);
+                if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
+                
+                it = directories.emplace(dir, std::move(abspath)).first;
+                msvc_details::push_filter_hierarchy(tree_filter, cache, it->second);
             }
-        }
-        
-        for (auto& path : files) {
-            tree_proj.push_node(item_strings[type], tree_proj.find_nth_sibling_with_name(tree_proj.begin() + 1, type))->push_attribute("Include", path);
+            
+            tree_proj.push_node(item_strings[type], item_group_file_proj)->push_attribute("Include", path);
         
             auto cl_item = tree_filter.push_node(item_strings[type], item_group_file_filter);
             cl_item->push_attribute("Include", path);
             
-            GET_ABS_PATH(abspath)
-            if (!abspath.empty()) {
-                tree_filter.push_node("Filter", cl_item)->text(abspath);
+            if (!it->second.empty()) {
+                tree_filter.push_node("Filter", cl_item)->text(it->second);
             }
         }
     }
 
-    static void target_set_item_definition_group_(xmloxx::tree& tree, std::string_view config, std::string_view scope, std::string_view elem, std::string_view value) {
-        auto [mode, plat, tag, comb] = msvc_details::extract_config(config);
-        tree.push_node(elem, msvc_details::find_item_definition_group_element(tree, comb, scope))->text(value);
+    // n is the config count of the solution and i the index of the config to write.
+    static void target_set_item_definition_group_(xmloxx::tree& tree, std::size_t n, std::size_t i, std::string_view scope, std::string_view elem, std::string_view value) {
+        tree.push_node(elem, msvc_details::find_item_definition_group_element(tree, n, i, scope))->text(value);
     }
 
-    static void target_append_property_group_(xmloxx::tree& tree, std::string_view condition, std::string_view scope, std::string_view value) {
-        auto [mode, plat, tag, comb] = msvc_details::extract_config(condition);
-        tree.push_node(scope,
-            tree.find_first_sibling_with_attribute(
-                tree.find_nth_sibling(tree.begin() + 1, 10), "Condition", comb))->text(value);
+    static void target_append_property_group_(xmloxx::tree& tree, std::size_t n, std::size_t i, std::string_view scope, std::string_view value) {
+        tree.push_node(scope, tree.find_nth_sibling(tree.begin() + 1, msvc_details::property_group_index(n, i)))->text(value);
     }
 
-    visual_studio_project::visual_studio_project(std::string_view sln_name, const std::vector<std::string>& configs)
-    : solution_name_(sln_name), solution_configs_(configs) {}
+    // LTO and PGO write to the same elements, whichever setter comes later overrides the value.
+    static void target_assign_element_(xmloxx::tree& tree, xmloxx::tree::iterator group, std::string_view elem, std::string_view value) {
+        if (auto it = tree.find_first_child_with_name(group, elem); it != tree.end()) {
+            it->text(value);
+        } else {
+            tree.push_node(elem, group)->text(value);
+        }
+    }
+
+    // MSVC rejects a C++ precompiled header in a C translation unit (C1853), so every .c item
+    // of the group opts out unless it already says how to use it.
+    static void target_exclude_c_sources_from_pch_(xmloxx::tree& tree_proj, xmloxx::tree::iterator item_group) {
+        std::unordered_set<const xmloxx::tree::node_type*> decided;
+        std::vector<xmloxx::tree::iterator>                c_sources;
+        for (auto& node : tree_proj) {
+            if (node.name() == "PrecompiledHeader") {
+                decided.insert(node.parent());
+            }
+        }
+        for (auto& node : tree_proj) {
+            auto include = node.find_attribute("Include");
+            if (node.parent() == item_group && include != node.end_attribute() && !decided.contains(&node) &&
+                (include->value.ends_with(".c") || include->value.ends_with(".C"))) {
+                c_sources.push_back(&node);
+            }
+        }
+        for (auto item : c_sources) {
+            tree_proj.push_node("PrecompiledHeader", item)->text("NotUsing");
+        }
+    }
+
+    visual_studio_project::visual_studio_project(std::string_view sln_name, const std::vector<std::string>& configs, std::pmr::memory_resource* mr)
+    : resource_(mr), solution_name_(sln_name) {
+        solution_configs_.reserve(configs.size());
+        for (std::string_view config : configs) {
+            solution_configs_.push_back(msvc_details::make_config_descriptor(config));
+        }
+    }
+
+    std::size_t visual_studio_project::find_config_(std::string_view config) const {
+        auto it = std::ranges::find(solution_configs_, config, &config_descriptor::name);
+        if (it == solution_configs_.end()) {
+            throw std::out_of_range(std::format("Configuration {:s} is not declared in PROJECT_CONFIGURATIONS!", config));
+        }
+        return it - solution_configs_.begin();
+    }
+
+    std::size_t visual_studio_project::find_target_(std::string_view target_name) const {
+        auto it = target_ids_.find(target_name);
+        if (it == target_ids_.end()) {
+            throw std::out_of_range(std::format("{:s} is not a target of this solution!", target_name));
+        }
+        return it->second;
+    }
 
     visual_studio_project& visual_studio_project::new_target(std::string_view target_name) {
         ////////////////////////////////////////////
         //                Filters                ///
         ////////////////////////////////////////////
 
-        auto& tree_filter = vcxproj_filters_map_.try_emplace(target_name, "Project", 1 << 15).first->second;
+        if (!target_ids_.try_emplace(std::string(target_name), targets_.size()).second) {
+            throw std::invalid_argument(std::format("Target {:s} is added twice to this solution!", target_name));
+        }
+        auto& state = targets_.emplace_back(std::string(target_name), msvc_details::generate_guid(),
+            xmloxx::tree("Project", 1 << 15, resource_), xmloxx::tree("Project", 1 << 15, resource_));
+
+        auto& tree_filter = state.filters;
         
         // Insert filter root project.
         tree_filter.begin()->push_attribute("ToolsVersion", "4.0")->push_attribute("xmlns", "http://schemas.microsoft.com/developer/msbuild/2003");
@@ -387,23 +524,21 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
         ////////////////////////////////////////////
         //                Project                ///
         ////////////////////////////////////////////
-        vcxproj_guid_map_[target_name] = msvc_details::generate_guid();
-        auto& tree_proj = vcxproj_map_.try_emplace(target_name, "Project", 1 << 15).first->second;
+        auto& tree_proj = state.project;
         
         tree_proj.begin()->push_attribute("DefaultTargets", "Build")->push_attribute("xmlns", "http://schemas.microsoft.com/developer/msbuild/2003");
 
         // Insert ItemGroup project configurations
         auto item_group_project_config = tree_proj.push_node("ItemGroup")->push_attribute("Label", "ProjectConfigurations");
-        for (std::string_view config : solution_configs_) {
-            auto[mode, plat, tag, comb] = msvc_details::extract_config(config);
-            auto project_config = tree_proj.push_node("ProjectConfiguration", item_group_project_config)->push_attribute("Include", tag);
-            tree_proj.push_node("Configuration", project_config)->text(mode);
-            tree_proj.push_node("Platform"     , project_config)->text(plat);
+        for (auto& config : solution_configs_) {
+            auto project_config = tree_proj.push_node("ProjectConfiguration", item_group_project_config)->push_attribute("Include", config.tag);
+            tree_proj.push_node("Configuration", project_config)->text(config.mode);
+            tree_proj.push_node("Platform"     , project_config)->text(config.platform);
         }
         
         // Insert global configurations
         auto property_group_globals = tree_proj.push_node("PropertyGroup")->push_attribute("Label", "Globals");
-        tree_proj.push_node("ProjectGuid"  , property_group_globals)->text(vcxproj_guid_map_[target_name]);
+        tree_proj.push_node("ProjectGuid"  , property_group_globals)->text(state.guid);
         tree_proj.push_node("RootNamespace", property_group_globals)->text(target_name);
         tree_proj.push_node("ProjectName"  , property_group_globals)->text(target_name);
         tree_proj.push_node("WindowsTargetPlatformVersion", property_group_globals)->text("10.0");
@@ -413,17 +548,14 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
         tree_proj.push_node("Import")->push_attribute("Project", "$(VCTargetsPath)\\Microsoft.Cpp.Default.props");
         
         // Insert configuration.
-        for (std::string_view config : solution_configs_) {
-            auto[mode, plat, tag, comb] = msvc_details::extract_config(config);
-            std::string mode_upper_norm = msvc_details::normalize_to_uppercase_mode(mode);
-        
+        for (auto& config : solution_configs_) {
             auto project_group_cond_config = tree_proj.push_node("PropertyGroup")
-            ->push_attribute("Condition", comb)->push_attribute("Label", "Configuration");
+            ->push_attribute("Condition", config.condition)->push_attribute("Label", "Configuration");
         
             tree_proj.push_node("ConfigurationType", project_group_cond_config)->text("Application");
             tree_proj.push_node("PlatformToolset",   project_group_cond_config)->text("v143");
             tree_proj.push_node("CharacterSet",      project_group_cond_config)->text("Unicode");
-            tree_proj.push_node("UseDebugLibraries", project_group_cond_config)->text(mode_upper_norm == "DEBUG" ? "true" : "false");
+            tree_proj.push_node("UseDebugLibraries", project_group_cond_config)->text(config.mode_upper == "DEBUG" ? "true" : "false");
         }
         tree_proj.push_node("Import")->push_attribute("Project", "$(VCTargetsPath)\\Microsoft.Cpp.props");
         
@@ -432,11 +564,9 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
         tree_proj.push_node("ImportGroup")->push_attribute("Label", "Shared");
         
         // Use for loop to set all config related properties.
-        for (std::string_view config : solution_configs_) {
-            auto[mode, plat, tag, comb] = msvc_details::extract_config(config);
-            
+        for (auto& config : solution_configs_) {
             auto import_group_property_sheets_config = tree_proj.push_node("ImportGroup")
-            ->push_attribute("Label", "PropertySheets")->push_attribute("Condition", comb);
+            ->push_attribute("Label", "PropertySheets")->push_attribute("Condition", config.condition);
         
             tree_proj.push_node("Import", import_group_property_sheets_config)
             ->push_attribute("Project", "$(UserRootDir)\\Microsoft.Cpp.$(Platform).user.props")
@@ -447,16 +577,13 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
         tree_proj.push_node("PropertyGroup")->push_attribute("Label", "UserMacros");
         
         // For OutDir and IntDir.
-        for (std::string_view config : solution_configs_) {
-            auto[mode, plat, tag, comb] = msvc_details::extract_config(config);
-            tree_proj.push_node("PropertyGroup")->push_attribute("Condition", comb);
+        for (auto& config : solution_configs_) {
+            tree_proj.push_node("PropertyGroup")->push_attribute("Condition", config.condition);
         }
         
         // Insert item definitions.
-        for (std::string_view config : solution_configs_) {
-            auto[mode, plat, tag, comb] = msvc_details::extract_config(config);
-            std::string mode_upper_norm = msvc_details::normalize_to_uppercase_mode(mode);
-            auto  idg = tree_proj.push_node("ItemDefinitionGroup")->push_attribute("Condition", comb);
+        for (auto& config : solution_configs_) {
+            auto  idg = tree_proj.push_node("ItemDefinitionGroup")->push_attribute("Condition", config.condition);
             
             auto  com = tree_proj.push_node("ClCompile", idg);
             tree_proj.push_node("WarningLevel",    com)->text("Level3");
@@ -467,7 +594,7 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
             tree_proj.push_node("GenerateDebugInformation", lnk)->text("true");
             
             // Release specific defines
-            if (mode_upper_norm != "DEBUG") {
+            if (config.mode_upper != "DEBUG") {
                 tree_proj.push_node("FunctionLevelLinking", com)->text("true");
                 tree_proj.push_node("IntrinsicFunctions",   com)->text("true");
                 tree_proj.push_node("EnableCOMDATFolding", lnk)->text("true");
@@ -499,39 +626,51 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
 
     visual_studio_project& visual_studio_project::target_headers(std::string_view target_name,
         const std::vector<std::string>& headers, const std::string& filter) {
-        target_attach_files_(vcxproj_filters_map_.at(target_name), vcxproj_map_.at(target_name), headers, filter, Attach_Headers);
+        auto& target = targets_[find_target_(target_name)];
+        target_attach_files_(target.filters, target.project, target.filter_state, headers, filter, Attach_Headers);
         return *this;        
     }
     
     visual_studio_project& visual_studio_project::target_sources(std::string_view target_name,
         const std::vector<std::string>& sources, const std::string& filter) {
-        target_attach_files_(vcxproj_filters_map_.at(target_name), vcxproj_map_.at(target_name), sources, filter, Attach_Sources);
+        auto& target = targets_[find_target_(target_name)];
+        target_attach_files_(target.filters, target.project, target.filter_state, sources, filter, Attach_Sources);
+        if (target.precompiled_header) {
+            target_exclude_c_sources_from_pch_(target.project, target.project.find_nth_sibling_with_name(target.project.begin() + 1, Attach_Sources));
+        }
         return *this;
     }
     
     visual_studio_project& visual_studio_project::target_msvc_icon(std::string_view target_name, std::string_view resource) {
+        auto& target = targets_[find_target_(target_name)];
         msvc_details::generate_resource(target_name, resource);
-        target_attach_files_(vcxproj_filters_map_.at(target_name), vcxproj_map_.at(target_name),
+        target_attach_files_(target.filters, target.project, target.filter_state,
             {std::filesystem::absolute(resource).generic_string()}, "./", Attach_Icon);
-        target_attach_files_(vcxproj_filters_map_.at(target_name), vcxproj_map_.at(target_name),
+        target_attach_files_(target.filters, target.project, target.filter_state,
             {std::filesystem::absolute(std::string(target_name) + ".rc").generic_string()}, "./", Attach_Resource);
         return *this;
     }
 
     visual_studio_project& visual_studio_project::target_dependencies(std::string_view target_name, const std::vector<std::string>& dependencies) {
-        auto& tree_proj    = vcxproj_map_.at(target_name);
+        auto& target       = targets_[find_target_(target_name)];
+        auto& tree_proj    = target.project;
         auto  item_group   = tree_proj.find_nth_sibling_with_name(tree_proj.begin() + 1, Attach_Dependency);
         for (std::string_view dependency : dependencies) {
+            auto id = target_ids_.find(dependency);
+            if (id == target_ids_.end()) {
+                throw std::out_of_range(std::format("Dependency {:s} of {:s} is not a target of this solution!", dependency, target_name));
+            }
             tree_proj.push_node("Project",
                 tree_proj.push_node("ProjectReference", item_group)->push_attribute("Include",  (std::string(dependency) + ".vcxproj")))
-            ->text(vcxproj_guid_map_[dependency]);
+            ->text(targets_[id->second].guid);
+            target.dependencies.push_back(id->second);
         }
         return *this;
     }
     
     
     visual_studio_project& visual_studio_project::target_type(std::string_view target_name, target_types type) {
-        auto& tree_proj       = vcxproj_map_.at(target_name);
+        auto& tree_proj       = targets_[find_target_(target_name)].project;
         auto  property_group  = tree_proj.find_nth_sibling(tree_proj.begin() + 1, 3);
         for (auto& config : solution_configs_) {
             tree_proj.find_first_child(property_group)->text(msvc_details::get_project_type_string(type));
@@ -542,8 +681,9 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
 
     visual_studio_project& visual_studio_project::target_std_cpp(std::string_view target_name,
         target_cpp_standards  version) {
-        for (auto& config : solution_configs_) {
-            target_set_item_definition_group_(vcxproj_map_.at(target_name), config,
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        for (std::size_t i = 0; i != solution_configs_.size(); ++i) {
+            target_set_item_definition_group_(tree_proj, solution_configs_.size(), i,
                 "ClCompile", "LanguageStandard", msvc_details::get_cpp_standard_string(version));
         }
         return *this;
@@ -551,8 +691,9 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
     
     visual_studio_project& visual_studio_project::target_std_c(std::string_view target_name,
         target_c_standards version) {
-        for (auto& config : solution_configs_) {
-            target_set_item_definition_group_(vcxproj_map_.at(target_name), config,
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        for (std::size_t i = 0; i != solution_configs_.size(); ++i) {
+            target_set_item_definition_group_(tree_proj, solution_configs_.size(), i,
                 "ClCompile", "LanguageStandard_C", msvc_details::get_c_standard_string(version));
         }
         return *this;
@@ -560,23 +701,92 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
     
     visual_studio_project& visual_studio_project::target_msvc_subsystem(std::string_view target_name,
         target_msvc_subsystems sys) {
-        for (auto& config : solution_configs_) {
-            target_set_item_definition_group_(vcxproj_map_.at(target_name), config,
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        for (std::size_t i = 0; i != solution_configs_.size(); ++i) {
+            target_set_item_definition_group_(tree_proj, solution_configs_.size(), i,
                 "Link", "SubSystem", msvc_details::get_subsystem_string(sys));
         }
         return *this;
     }
     
     
+    visual_studio_project& visual_studio_project::target_unity_build(std::string_view target_name, std::uint32_t batch_size) {
+        if (batch_size == 0) {
+            return *this;
+        }
+        // MSBuild builds the unity files itself, batches never cross a folder so an edit only invalidates its own batch.
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        for (std::size_t i = 0; i != solution_configs_.size(); ++i) {
+            tree_proj.push_node("EnableUnitySupport",
+                tree_proj.find_nth_sibling(tree_proj.begin() + 1, msvc_details::configuration_group_index(i)))->text("true");
+            target_set_item_definition_group_(tree_proj, solution_configs_.size(), i, "ClCompile", "MaxFilesInUnityFile", std::to_string(batch_size));
+            target_set_item_definition_group_(tree_proj, solution_configs_.size(), i, "ClCompile", "CombineFilesOnlyFromTheSameFolder", "true");
+        }
+        return *this;
+    }
+    
+    visual_studio_project& visual_studio_project::target_precompiled_header(std::string_view target_name, std::string_view header, std::string_view source) {
+        auto& target    = targets_[find_target_(target_name)];
+        auto& tree_proj = target.project;
+        // Without a source nothing creates the .pch and every Use would fail.
+        if (source.empty()) {
+            return *this;
+        }
+        // Header is matched against #include text by MSVC so it's written as is.
+        for (std::size_t i = 0; i != solution_configs_.size(); ++i) {
+            target_set_item_definition_group_(tree_proj, solution_configs_.size(), i, "ClCompile", "PrecompiledHeader",     "Use");
+            target_set_item_definition_group_(tree_proj, solution_configs_.size(), i, "ClCompile", "PrecompiledHeaderFile", header);
+        }
+        auto item_group = tree_proj.find_nth_sibling_with_name(tree_proj.begin() + 1, Attach_Sources);
+        auto item       = tree_proj.find_first_child_with_attribute(item_group, "Include", source);
+        if (item == tree_proj.end()) {
+            target_sources(target_name, {std::string(source)});
+            item = tree_proj.find_first_child_with_attribute(item_group, "Include", source);
+        }
+        tree_proj.push_node("PrecompiledHeader", item)->text("Create");
+        // Sources attached later opt out in target_sources.
+        target.precompiled_header = true;
+        target_exclude_c_sources_from_pch_(tree_proj, item_group);
+        return *this;
+    }
+    
+    visual_studio_project& visual_studio_project::target_msvc_multiprocessor(std::string_view target_name, std::uint32_t jobs) {
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        if (jobs == 0) {
+            return *this;
+        }
+        for (std::size_t i = 0; i != solution_configs_.size(); ++i) {
+            target_set_item_definition_group_(tree_proj, solution_configs_.size(), i, "ClCompile", "MultiProcessorCompilation", "true");
+            target_set_item_definition_group_(tree_proj, solution_configs_.size(), i, "ClCompile", "ProcessorNumber", std::to_string(jobs));
+        }
+        return *this;
+    }
+
+    visual_studio_project& visual_studio_project::target_msvc_codegen_threads(std::string_view target_name, std::uint32_t threads) {
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        if (threads == 0) {
+            return *this;
+        }
+        for (std::size_t i = 0; i != solution_configs_.size(); ++i) {
+            target_set_item_definition_group_(tree_proj, solution_configs_.size(), i,
+                "ClCompile", "AdditionalOptions", std::format("/cgthreads{:d} %(AdditionalOptions)", threads));
+        }
+        return *this;
+    }
+    
     visual_studio_project& visual_studio_project::target_optimization(std::string_view target_name, target_optimizations op, std::string_view config) {
-        target_set_item_definition_group_(vcxproj_map_.at(target_name), config, "ClCompile", "Optimization", msvc_details::get_optimization_string(op));
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        auto  index = find_config_(config);
+        target_set_item_definition_group_(tree_proj, solution_configs_.size(), index,
+            "ClCompile", "Optimization", msvc_details::get_optimization_string(op));
         return *this;
     }
     
     visual_studio_project& visual_studio_project::target_defines(std::string_view target_name, const std::vector<std::string>& defines, std::string_view config) {
-        auto nmode = msvc_details::normalize_to_uppercase_mode(std::get<0>(msvc_details::extract_config(config)));
-        std::string_view mac = nmode == "DEBUG" ? "_DEBUG" : "NDEBUG";
-        target_set_item_definition_group_(vcxproj_map_.at(target_name), config,
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        auto  index = find_config_(config);
+        std::string_view mac = solution_configs_[index].mode_upper == "DEBUG" ? "_DEBUG" : "NDEBUG";
+        target_set_item_definition_group_(tree_proj, solution_configs_.size(), index,
             "ClCompile", "PreprocessorDefinitions", std::format("{:s};{:s};%(PreprocessorDefinitions)",
                 msvc_details::convert_list_to_string(defines, "", [](const std::string& i) { return i; }), mac));
         return *this;
@@ -584,8 +794,9 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
     
     visual_studio_project& visual_studio_project::target_external_link_directories(std::string_view target_name,
         const std::vector<std::string>& dirs) {
-        for (auto& config : solution_configs_) {
-            target_set_item_definition_group_(vcxproj_map_.at(target_name), config,
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        for (std::size_t i = 0; i != solution_configs_.size(); ++i) {
+            target_set_item_definition_group_(tree_proj, solution_configs_.size(), i,
         "Link", "AdditionalLibraryDirectories",
         msvc_details::convert_list_to_string(dirs, "", [](const std::string& i) {
                      return std::filesystem::path(i).lexically_normal().generic_string();
@@ -596,8 +807,9 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
     
     visual_studio_project& visual_studio_project::target_external_include_directories(std::string_view target_name,
         const std::vector<std::string>& dirs) {
-        for (auto& config : solution_configs_) {
-            target_set_item_definition_group_(vcxproj_map_.at(target_name), config,
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        for (std::size_t i = 0; i != solution_configs_.size(); ++i) {
+            target_set_item_definition_group_(tree_proj, solution_configs_.size(), i,
         "ClCompile", "AdditionalIncludeDirectories",
         msvc_details::convert_list_to_string(dirs, "", [](const std::string& i) {
                      return std::filesystem::path(i).lexically_normal().generic_string();
@@ -607,7 +819,9 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
     }
     
     visual_studio_project& visual_studio_project::target_external_links(std::string_view target_name, const std::vector<std::string>& links, std::string_view config) {
-        target_set_item_definition_group_(vcxproj_map_.at(target_name), config,
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        auto  index = find_config_(config);
+        target_set_item_definition_group_(tree_proj, solution_configs_.size(), index,
             "Link", "AdditionalDependencies",
             std::format("{:s};%(AdditionalDependencies)", msvc_details::convert_list_to_string(links, ".lib",
                  [](const std::string& i) { return i; })));
@@ -615,12 +829,70 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
     }
     
     visual_studio_project& visual_studio_project::target_binary_directory(std::string_view target_name, std::string_view dir, std::string_view config) {
-        target_append_property_group_(vcxproj_map_.at(target_name), config, "OutDir", dir);
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        auto  index = find_config_(config);
+        target_append_property_group_(tree_proj, solution_configs_.size(), index, "OutDir", dir);
         return *this;
     }
     
     visual_studio_project& visual_studio_project::target_intermediate_directory(std::string_view target_name, std::string_view dir, std::string_view config) {
-        target_append_property_group_(vcxproj_map_.at(target_name), config, "IntDir", dir);
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        auto  index = find_config_(config);
+        target_append_property_group_(tree_proj, solution_configs_.size(), index, "IntDir", dir);
+        return *this;
+    }
+
+    visual_studio_project& visual_studio_project::target_instruction_set(std::string_view target_name, target_instruction_sets isa, std::string_view config) {
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        std::string_view value = msvc_details::get_instruction_set_string(isa);
+        if (value.empty()) {
+            return *this;
+        }
+        target_set_item_definition_group_(tree_proj, solution_configs_.size(), find_config_(config),
+            "ClCompile", "EnableEnhancedInstructionSet", value);
+        return *this;
+    }
+
+    visual_studio_project& visual_studio_project::target_lto(std::string_view target_name, bool enable, std::string_view config) {
+        // WholeProgramOptimization turns on both /GL and /LTCG.
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        auto  index     = find_config_(config);
+        target_assign_element_(tree_proj, tree_proj.find_nth_sibling(tree_proj.begin() + 1, msvc_details::configuration_group_index(index)),
+            "WholeProgramOptimization", enable ? "true" : "false");
+        if (enable) {
+            target_assign_element_(tree_proj, msvc_details::find_item_definition_group_element(tree_proj, solution_configs_.size(), index, "Link"),
+                "LinkTimeCodeGeneration", "UseLinkTimeCodeGeneration");
+        }
+        return *this;
+    }
+
+    visual_studio_project& visual_studio_project::target_pgo_phase(std::string_view target_name, target_pgo_phases phase, std::string_view config) {
+        if (phase == target_pgo_phases::none) {
+            return *this;
+        }
+        // Profile guided optimization requires whole program optimization in both phases.
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        auto  index     = find_config_(config);
+        target_assign_element_(tree_proj, tree_proj.find_nth_sibling(tree_proj.begin() + 1, msvc_details::configuration_group_index(index)),
+            "WholeProgramOptimization", "true");
+        target_assign_element_(tree_proj, msvc_details::find_item_definition_group_element(tree_proj, solution_configs_.size(), index, "Link"),
+            "LinkTimeCodeGeneration", msvc_details::get_pgo_link_string(phase));
+        return *this;
+    }
+
+    visual_studio_project& visual_studio_project::target_msvc_incremental_link(std::string_view target_name, bool enable, std::string_view config) {
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        auto  index = find_config_(config);
+        target_append_property_group_(tree_proj, solution_configs_.size(), index, "LinkIncremental", enable ? "true" : "false");
+        return *this;
+    }
+
+    visual_studio_project& visual_studio_project::target_msvc_debug_fastlink(std::string_view target_name, bool enable, std::string_view config) {
+        // new_target always writes GenerateDebugInformation, so the existing value is replaced.
+        auto& tree_proj = targets_[find_target_(target_name)].project;
+        auto  index     = find_config_(config);
+        auto  lnk       = msvc_details::find_item_definition_group_element(tree_proj, solution_configs_.size(), index, "Link");
+        tree_proj.find_first_child_with_name(lnk, "GenerateDebugInformation")->text(enable ? "DebugFastLink" : "true");
         return *this;
     }
 
@@ -630,19 +902,25 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
         std::ofstream solution(std::filesystem::path(root) / (solution_name_ + ".sln"));
         tiny_print(solution, "Microsoft Visual Studio Solution File, Format Version 12.00\n");
         std::string sln_guid = msvc_details::generate_guid();
-        for (const auto target : vcxproj_guid_map_ | std::views::keys) {
-            tiny_print(solution, "Project(\"{0:s}\") = \"{1:s}\", \"{1:s}.vcxproj\", \"{2:s}\"\nEndProject\n", sln_guid, target, vcxproj_guid_map_[target]);
+        for (const auto& target : targets_) {
+            tiny_print(solution, "Project(\"{0:s}\") = \"{1:s}\", \"{1:s}.vcxproj\", \"{2:s}\"\n", sln_guid, target.name, target.guid);
+            if (!target.dependencies.empty()) {
+                tiny_print(solution, "\tProjectSection(ProjectDependencies) = postProject\n");
+                for (auto dependency : target.dependencies) {
+                    tiny_print(solution, "\t\t{0:s} = {0:s}\n", targets_[dependency].guid);
+                }
+                tiny_print(solution, "\tEndProjectSection\n");
+            }
+            tiny_print(solution, "EndProject\n");
         }
         tiny_print(solution, "Global\n    GlobalSection(SolutionConfigurationPlatforms) = preSolution\n");
         for (auto& config : solution_configs_) {
-            auto[mode, plat, tag, comb] = msvc_details::extract_config(config);
-            tiny_print(solution, "        {0:s} = {0:s}\n", tag);
+            tiny_print(solution, "        {0:s} = {0:s}\n", config.tag);
         }
         tiny_print(solution, "    EndGlobalSection\n    GlobalSection(ProjectConfigurationPlatforms) = postSolution\n");
-        for (auto& guid : vcxproj_guid_map_ | std::views::values) {
+        for (const auto& target : targets_) {
             for (auto& config : solution_configs_) {
-                auto[mode, plat, tag, comb] = msvc_details::extract_config(config);
-                tiny_print(solution, "        {0:s}.{1:s}.ActiveCfg = {1:s}\n        {0:s}.{1:s}.Build.0 = {1:s}\n", guid, tag);
+                tiny_print(solution, "        {0:s}.{1:s}.ActiveCfg = {1:s}\n        {0:s}.{1:s}.Build.0 = {1:s}\n", target.guid, config.tag);
             }
         }
         tiny_print(solution, "    EndGlobalSection\n	 GlobalSection(SolutionProperties) = preSolution\n        HideSolutionNode = FALSE\n    EndGlobalSection\nEndGlobal");
@@ -650,8 +928,10 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
     }
 
     void visual_studio_project::save_targets_to_files(std::string_view root) {
-        msvc_details::xml_save_map_to_file(vcxproj_map_, ".vcxproj", root);
-        msvc_details::xml_save_map_to_file(vcxproj_filters_map_, ".vcxproj.filters", root);
+        for (const auto& target : targets_) {
+            msvc_details::xml_save_to_file(target.project, target.name, ".vcxproj", root);
+            msvc_details::xml_save_to_file(target.filters, target.name, ".vcxproj.filters", root);
+        }
     }
 
     ////////////////////////////////////////////////////////////////////////////////////
@@ -693,90 +973,194 @@ if (!abspath.empty() && abspath.back() == '\\') { abspath.pop_back(); }
         std::ifstream     header("./makexx.generated.hpp");
         std::string       str;
         std::copy(std::istreambuf_iterator<char>(header), std::istreambuf_iterator<char>(), std::back_inserter(str));
-        static cpod::archive static_archive(std::move(str));
-        get_header_archive_from_buffer(static_archive, definition_map_);
+        cpod::archive header_archive(std::move(str), &arena_requests_);
+        get_header_archive_from_buffer(header_archive, definition_holder_, definition_map_);
     }
 
-    void make_application::read_source_and_split_targets_() {
-        read_current_definition_map_();
-        
-        if (argc_ < 3) {
-            tiny_print(std::cout, "Error, must have project description path argument!\n");
-            return;
+    namespace generator_details {
+        // Runs fn(i) for every i below count on all cores, indices are handed out one at a time
+        // so a slow item never holds up a queue of others. fn must not touch the run arena, it is not thread-safe.
+        template <class F>
+        static void parallel_for(std::size_t count, F fn) {
+            std::atomic<std::size_t> next = 0;
+            auto worker = [&]() {
+                for (std::size_t i; (i = next.fetch_add(1)) < count;) {
+                    fn(i);
+                }
+            };
+            std::size_t thread_count = std::min<std::size_t>(std::max(1u, std::thread::hardware_concurrency()), count);
+            std::vector<std::thread> threads;
+            for (std::size_t i = 1; i < thread_count; ++i) {
+                threads.emplace_back(worker);
+            }
+            worker();
+            for (auto& thread : threads) {
+                thread.join();
+            }
+        }
+    }
+
+    // Prints every diagnostic, true when none of them is an error.
+    static bool report_diagnostics_(const std::vector<cpod::diagnostic>& diagnostics) {
+        bool clean = true;
+        for (const auto& d : diagnostics) {
+            tiny_print(std::cout, "{:s}\n", cpod::to_string(d));
+            clean = clean && d.severity != cpod::severity_error;
+        }
+        return clean;
+    }
+
+    // A directory stands for every *.make.cpp directly in it, in name order.
+    static bool collect_description_paths_(std::string_view arg, std::vector<std::string>& paths) {
+        if (!std::filesystem::is_directory(arg)) {
+            paths.emplace_back(arg);
+            return true;
+        }
+        std::vector<std::string> found;
+        for (const auto& entry : std::filesystem::directory_iterator(arg)) {
+            if (entry.is_regular_file() && entry.path().filename().generic_string().ends_with(".make.cpp")) {
+                found.push_back(entry.path().generic_string());
+            }
+        }
+        if (found.empty()) {
+            tiny_print(std::cout, "Error, no *.make.cpp description in {:s}!\n", arg);
+            return false;
         }
+        std::ranges::sort(found);
+        paths.insert(paths.end(), found.begin(), found.end());
+        return true;
+    }
 
-        std::string_view    project_desc_path = argv_[2];
-        std::ifstream       ifs(project_desc_path.data());
+    // Splits a description into its project scope and target namespaces, false when it can't be read.
+    static bool split_description_(project_description& description) {
+        std::string_view    project_desc_path = description.path;
+        std::ifstream       ifs(description.path);
 
         if (!ifs.good()) {
-            tiny_print(std::cout, "Error, invalid description path!\n");
-            return;
+            return false;
         }
 
-        std::string   source_cache;
+        // Every piece starts with a #line directive and dropped lines stay as empty ones, so diagnostics
+        // point into the description file.
+        std::string   source_cache = std::format("#line 1 \"{:s}\"\n", project_desc_path);
         bool          before_first_namespace = true;
         std::size_t   scope_count = 0;
+        std::size_t   line_number = 0;
         std::string   current_scope_name;
 
         // Split all targets.
         for (std::string line_cache; std::getline(ifs, line_cache);) {
+            ++line_number;
             if (before_first_namespace) {
                 if (line_cache == "#pragma target_definitions") {
                     before_first_namespace = false;
-                    mxx_project_source_fields_["project_scope"] = source_cache;
+                    description.source_fields["project_scope"] = source_cache;
                     source_cache.clear();
                 }
                 else {
+                    // The generated header only serves the IDE, its macros are in definition_map_ already.
                     if (line_cache.find("#include") == std::string::npos) {
                         source_cache.append(line_cache);
-                        source_cache.push_back('\n');
                     }
+                    else if (line_cache.find("makexx.generated.hpp") == std::string::npos) {
+                        source_cache.append(line_cache);
+                        description.includes.append(std::format("#line {:d} \"{:s}\"\n{:s}\n", line_number, project_desc_path, line_cache));
+                    }
+                    source_cache.push_back('\n');
                 }
             }
-            else {
+            else if (scope_count == 0) {
+                // A target starts at its namespace line, anything between targets is dropped.
                 if (auto b = line_cache.find("namespace"); b != std::string::npos) {
-                    // The first one.
                     std::size_t end = line_cache.find(' ', b + 10);
-                    std::string scope_name_cache = line_cache.substr(b + 10, end - b - 10);
-                    if (scope_count == 0) {
-                        current_scope_name = scope_name_cache;
-                    } else {
-                        source_cache.append(std::format("#pragma target_config {:s}\n", scope_name_cache));
-                    }
-                    ++scope_count;
+                    current_scope_name = line_cache.substr(b + 10, end - b - 10);
+                    source_cache = std::format("#line {:d} \"{:s}\"\n", line_number + 1, project_desc_path);
+                    scope_count = 1;
                 }
-                else {
-                    if (line_cache.find('{') != std::string::npos) {
-                        ++scope_count;
-                    }
-                    if (line_cache.find('}') != std::string::npos) {
-                        if (scope_count == 1) {
-                            mxx_project_source_fields_[current_scope_name] = source_cache;
-                            source_cache.clear();
-                        }
-                        --scope_count;
-                    }
-                    std::erase_if(line_cache, [](auto& it){ return std::isspace(it) && std::isspace((&it)[1]); });
-                    if (line_cache != " }") {
-                        source_cache.append(line_cache);
-                        source_cache.push_back('\n');
-                    }
+            }
+            else {
+                // Config namespaces stay in the source, the compiler records their variables as config::name
+                // whether they are written out or produced by a macro.
+                scope_count += std::ranges::count(line_cache, '{');
+                scope_count -= std::min<std::size_t>(scope_count, std::ranges::count(line_cache, '}'));
+                if (scope_count == 0) {
+                    description.source_fields[current_scope_name] = std::move(source_cache);
+                    source_cache.clear();
+                } else {
+                    source_cache.append(line_cache);
+                    source_cache.push_back('\n');
                 }
             }
         }
-        
+        return true;
+    }
+
+    bool make_application::read_source_and_split_targets_(const std::vector<std::string>& description_paths) {
+        read_current_definition_map_();
+        include_cache_ = std::make_shared<cpod::include_cache>();
+
+        // Descriptions are independent until their targets are merged, all are split and compiled at once.
+        auto& descriptions = mxx_project_descriptions_;
+        descriptions.assign(description_paths.size(), {});
+        std::vector<std::uint8_t> readable(descriptions.size());
+        generator_details::parallel_for(descriptions.size(), [&](std::size_t i) {
+            descriptions[i].path = description_paths[i];
+            readable[i] = split_description_(descriptions[i]);
+        });
+        for (std::size_t i = 0; i < descriptions.size(); ++i) {
+            if (!readable[i]) {
+                tiny_print(std::cout, "Error, invalid description path {:s}!\n", descriptions[i].path);
+                return false;
+            }
+        }
+
         // Read project scope data.
-        cpod::archive current_archive(mxx_project_source_fields_["project_scope"]);
-        current_archive.compile_content_default(definition_map_);
-            
-#define FIND_AND_GET_PROPERTY(fn) do { \
-if (auto it = current_archive.find_variable_begin<decltype(fn)>(#fn); it != current_archive.content_end()) {\
-    cpod::serializer<decltype(fn)>{}(it, fn, 0); \
+        std::vector<cpod::archive::section> sections;
+        for (auto& description : descriptions) {
+            sections.push_back({ cpod::archive(description.source_fields["project_scope"]), {}, {} });
+        }
+        cpod::archive::compile_many(sections, definition_map_, 0, include_cache_.get(), &compile_upstream_);
+        bool clean = true;
+        for (const auto& section : sections) {
+            clean = report_diagnostics_(section.diagnostics) && clean;
+        }
+        if (!clean) {
+            return false;
+        }
+
+#define FIND_AND_GET_PROPERTY(fn, value) do { \
+if (auto it = current_archive.find_variable_begin<decltype(value)>(#fn); it != current_archive.content_end()) {\
+    cpod::serializer<decltype(value)>{}(it, value, 0); \
 }} while (false)
 
-        FIND_AND_GET_PROPERTY(mxx_project_name);
-        FIND_AND_GET_PROPERTY(mxx_project_targets);
-        FIND_AND_GET_PROPERTY(mxx_project_configurations);
+        for (std::size_t i = 0; i < descriptions.size(); ++i) {
+            auto& current_archive = sections[i].arch;
+            FIND_AND_GET_PROPERTY(mxx_project_name, descriptions[i].name);
+            FIND_AND_GET_PROPERTY(mxx_project_targets, descriptions[i].targets);
+            FIND_AND_GET_PROPERTY(mxx_project_configurations, descriptions[i].configurations);
+        }
+#undef FIND_AND_GET_PROPERTY
+
+        // The solution is named after the first description, targets may depend on those of any other.
+        mxx_project_name = descriptions.front().name;
+        mxx_project_targets.clear();
+        mxx_project_configurations.clear();
+        std::unordered_map<std::string_view, std::string_view> declared_by;
+        for (const auto& description : descriptions) {
+            for (const auto& target : description.targets) {
+                if (auto [it, inserted] = declared_by.emplace(target, description.path); !inserted) {
+                    tiny_print(std::cout, "Error, target {:s} is declared by both {:s} and {:s}!\n", target, it->second, description.path);
+                    return false;
+                }
+                mxx_project_targets.push_back(target);
+            }
+            for (const auto& config : description.configurations) {
+                if (std::ranges::find(mxx_project_configurations, config) == mxx_project_configurations.end()) {
+                    mxx_project_configurations.push_back(config);
+                }
+            }
+        }
+        return true;
     }
 
     namespace generator_details {
@@ -825,8 +1209,507 @@ if (auto it = current_archive.find_variable_begin<decltype(fn)>(#fn); it != curr
             }
             return result;
         }
+
+        template <class Ty>
+        struct is_optional : std::false_type {};
+
+        template <class Ty>
+        struct is_optional<std::optional<Ty>> : std::true_type {};
+
+        // Reads one target property if the description wrote it, enums are stored as std::uint32_t.
+        template <class Ty>
+        static bool find_and_get_target_property(cpod::archive& arch, std::string_view name, Ty& value) {
+            if constexpr (is_optional<Ty>::value) {
+                typename Ty::value_type cache{};
+                if (!find_and_get_target_property(arch, name, cache)) {
+                    return false;
+                }
+                value = cache;
+                return true;
+            }
+            else if constexpr (std::is_enum_v<Ty>) {
+                std::uint32_t cache = 0;
+                if (!find_and_get_target_property(arch, name, cache)) {
+                    return false;
+                }
+                value = static_cast<Ty>(cache);
+                return true;
+            }
+            else {
+                if (auto it = arch.find_variable_begin<Ty>(name); it != arch.content_end()) {
+                    cpod::serializer<Ty>{}(it, value, 0);
+                    return true;
+                }
+                return false;
+            }
+        }
     }
 
+    // Flags for GCC compatible drivers (gcc, clang), shared by every generator that is not MSVC.
+    namespace gcc_details {
+
+        // Latest is the newest standard GCC 11 and clang 12 accept, c++2c needs GCC 14 or clang 17.
+        static const char* get_cpp_standard_string(target_cpp_standards standard) {
+            static constexpr const char* standards[] = { "", "-std=c++2b", "-std=c++11", "-std=c++14", "-std=c++17", "-std=c++20", "-std=c++23", "-std=c++2c" };
+            return standards[static_cast<std::uint32_t>(standard)];
+        }
+
+        static const char* get_c_standard_string(target_c_standards standard) {
+            static constexpr const char* standards[] = { "", "-std=c2x", "-std=c11", "-std=c17", "-std=c2x" };
+            return standards[static_cast<std::uint32_t>(standard)];
+        }
+
+        static const char* get_optimization_string(target_optimizations op) {
+            static constexpr const char* optimizations[] = { "", "-O0", "-Os", "-O2", "-O3" };
+            return optimizations[static_cast<std::uint32_t>(op)];
+        }
+
+        static const char* get_instruction_set_string(target_instruction_sets isa) {
+            static constexpr const char* isas[] = { "", "-msse2", "-mavx", "-mavx2", "-mavx512f", "-march=native" };
+            return isas[static_cast<std::uint32_t>(isa)];
+        }
+
+        static const char* get_pgo_string(target_pgo_phases phase) {
+            static constexpr const char* phases[] = { "", "", "-fprofile-generate", "-fprofile-use" };
+            return phases[static_cast<std::uint32_t>(phase)];
+        }
+
+        // Same rule as the Visual Studio projects, which compile .C as C as well. The language is
+        // passed with -x, so it does not depend on the driver's own extension table.
+        static bool is_c_source(std::string_view path) {
+            return path.ends_with(".c") || path.ends_with(".C");
+        }
+
+        static const target_config_properties* find_config(const target_properties& props, std::string_view config) {
+            auto it = std::ranges::find(props.configs, config, &target_config_properties::name);
+            return it == props.configs.end() ? nullptr : &*it;
+        }
+
+        // Objects keep the source layout below the intermediate directory so equal file names never collide,
+        // without one they go to <root>/build/<config>/obj/<target>/.
+        static std::string object_path(const target_properties& props, const target_config_properties* config,
+            std::string_view config_name, std::string_view source, std::string_view root) {
+            std::filesystem::path dir = config && !config->intermediate_directory.empty()
+                ? std::filesystem::path(config->intermediate_directory)
+                : std::filesystem::path(root) / "build" / config_name / "obj" / props.name;
+            auto relative = std::filesystem::path(source).lexically_relative(root);
+            if (relative.empty() || *relative.begin() == "..") {
+                relative = std::filesystem::path(source).filename();
+            }
+            relative += ".o";
+            return (dir / relative).lexically_normal().generic_string();
+        }
+
+        // A static library linked into a shared one, directly or through other static libraries,
+        // must be position independent as well. Dependents come first in reverse graph order.
+        static std::vector<std::uint8_t> position_independent_targets(const std::vector<target_properties>& targets, const target_graph& graph) {
+            std::vector<std::uint8_t> pic(targets.size());
+            for (auto t : graph.order | std::views::reverse) {
+                auto type = targets[t].type.value_or(target_types::exe);
+                pic[t] = type == target_types::dll || (type == target_types::lib &&
+                    std::ranges::any_of(graph.dependents[t], [&](std::size_t d) { return targets[d].type.value_or(target_types::exe) != target_types::exe && pic[d]; }));
+            }
+            return pic;
+        }
+
+        // Everything but the source, object and language specific standard.
+        static std::vector<std::string> common_arguments(const target_properties& props, const target_config_properties* config,
+            std::string_view config_name, bool position_independent) {
+            std::vector<std::string> args;
+            auto mode = config_name.substr(config_name.find('_') + 1);
+            args.emplace_back(msvc_details::normalize_to_uppercase_mode(mode) == "DEBUG" ? "-D_DEBUG" : "-DNDEBUG");
+            if (config) {
+                for (const auto& define : config->defines) {
+                    args.emplace_back("-D" + define);
+                }
+                if (config->optimization)    { args.emplace_back(get_optimization_string(*config->optimization)); }
+                if (config->instruction_set) { args.emplace_back(get_instruction_set_string(*config->instruction_set)); }
+                if (config->lto && *config->lto) { args.emplace_back("-flto"); }
+                if (config->pgo_phase && *config->pgo_phase != target_pgo_phases::none) { args.emplace_back(get_pgo_string(*config->pgo_phase)); }
+            }
+            if (position_independent) {
+                args.emplace_back("-fPIC");
+            }
+            for (const auto& dir : props.external_include_directories) {
+                args.emplace_back("-I" + dir);
+            }
+            return args;
+        }
+
+        static void append_json_string(std::string& out, std::string_view str) {
+            out.push_back('"');
+            for (auto c : str) {
+                switch (c) {
+                case '"':  out.append("\\\""); break;
+                case '\\': out.append("\\\\"); break;
+                case '\n': out.append("\\n");  break;
+                case '\t': out.append("\\t");  break;
+                default:
+                    if (static_cast<unsigned char>(c) < 0x20) {
+                        std::format_to(std::back_inserter(out), "\\u{:04x}", static_cast<unsigned>(c));
+                    } else {
+                        out.push_back(c);
+                    }
+                }
+            }
+            out.push_back('"');
+        }
+
+        // Full driver invocation for one translation unit, the compile database and the build driver share it.
+        static std::vector<std::string> compile_arguments(const target_properties& props, const std::vector<std::string>& common,
+            std::string_view source, std::string_view object) {
+            bool c_source = is_c_source(source);
+            std::vector<std::string> args { c_source ? "cc" : "c++", "-x", c_source ? "c" : "c++" };
+            if (!c_source && props.std_cpp) {
+                args.emplace_back(get_cpp_standard_string(*props.std_cpp));
+            }
+            if (c_source && props.std_c) {
+                args.emplace_back(get_c_standard_string(*props.std_c));
+            }
+            args.insert(args.end(), common.begin(), common.end());
+            args.insert(args.end(), { "-c", std::string(source), "-o", std::string(object) });
+            return args;
+        }
+
+        // Executables land in the binary directory as is, libraries get the usual lib prefix and suffix.
+        static std::string binary_path(const target_properties& props, const target_config_properties* config,
+            std::string_view config_name, std::string_view root) {
+            std::filesystem::path dir = config && !config->binary_directory.empty()
+                ? std::filesystem::path(config->binary_directory)
+                : std::filesystem::path(root) / "build" / config_name;
+            switch (props.type.value_or(target_types::exe)) {
+            case target_types::lib: return (dir / ("lib" + props.name + ".a")).lexically_normal().generic_string();
+            case target_types::dll: return (dir / ("lib" + props.name + ".so")).lexically_normal().generic_string();
+            default:                return (dir / props.name).lexically_normal().generic_string();
+            }
+        }
+
+        // One compile_commands.json entry per source, entries are separated but not terminated by ",\n".
+        static std::string compile_commands_of(const target_properties& props, std::string_view config_name, std::string_view root,
+            bool position_independent) {
+            std::string result;
+            auto        config = find_config(props, config_name);
+            auto        common = common_arguments(props, config, config_name, position_independent);
+            for (const auto& source : props.sources) {
+                if (!result.empty()) {
+                    result.append(",\n");
+                }
+                result.append("  {\n    \"directory\": ");
+                append_json_string(result, root);
+                result.append(",\n    \"file\": ");
+                append_json_string(result, source);
+                result.append(",\n    \"arguments\": [");
+                bool first = true;
+                for (const auto& arg : compile_arguments(props, common, source, object_path(props, config, config_name, source, root))) {
+                    result.append(first ? "" : ", ");
+                    append_json_string(result, arg);
+                    first = false;
+                }
+                result.append("]\n  }");
+            }
+            return result;
+        }
+    }
+
+    // Helpers of the -b driver, which runs the compiler itself instead of writing project files.
+    namespace build_details {
+
+        // POSIX shell quoting, an embedded quote closes the string, is escaped and reopens it.
+        static std::string join_command(const std::vector<std::string>& args) {
+            std::string command;
+            for (const auto& arg : args) {
+                command.append(command.empty() ? "'" : " '");
+                for (auto c : arg) {
+                    if (c == '\'') {
+                        command.append("'\\''");
+                    } else {
+                        command.push_back(c);
+                    }
+                }
+                command.push_back('\'');
+            }
+            return command;
+        }
+
+        static std::string read_file(const std::string& path) {
+            std::ifstream ifs(path, std::ios::binary);
+            return { std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>() };
+        }
+
+        static void write_file(const std::string& path, std::string_view content) {
+            std::ofstream ofs(path, std::ios::binary);
+            ofs.rdbuf()->sputn(content.data(), content.size());
+        }
+
+        // Prerequisites of a make style depfile written by -MMD, escaped spaces and line continuations included.
+        static std::vector<std::string> parse_depfile(const std::string& path) {
+            std::string              content = read_file(path);
+            std::vector<std::string> deps;
+            std::string              current;
+            bool                     after_colon = false;
+            auto flush = [&]() {
+                if (after_colon && !current.empty()) {
+                    deps.emplace_back(std::move(current));
+                }
+                current.clear();
+            };
+            for (std::size_t i = 0; i < content.size(); ++i) {
+                char c = content[i];
+                if (c == '\\' && i + 1 < content.size()) {
+                    if (content[i + 1] == ' ') {
+                        current.push_back(' ');
+                        ++i;
+                        continue;
+                    }
+                    if (content[i + 1] == '\n' || content[i + 1] == '\r') {
+                        ++i;
+                        continue;
+                    }
+                }
+                if (std::isspace(static_cast<unsigned char>(c))) {
+                    flush();
+                }
+                else if (c == ':' && !after_colon && (i + 1 == content.size() || std::isspace(static_cast<unsigned char>(content[i + 1])))) {
+                    current.clear();
+                    after_colon = true;
+                }
+                else {
+                    current.push_back(c);
+                }
+            }
+            flush();
+            return deps;
+        }
+
+        // An output is current when it was produced by the same command and nothing it was built from is newer.
+        // The command lives next to the output in <output>.cmd.
+        static bool is_up_to_date(const std::string& output, const std::vector<std::string>& inputs, std::string_view command) {
+            std::error_code ec;
+            auto output_time = std::filesystem::last_write_time(output, ec);
+            if (ec || read_file(output + ".cmd") != command) {
+                return false;
+            }
+            for (const auto& input : inputs) {
+                auto input_time = std::filesystem::last_write_time(input, ec);
+                if (ec || input_time > output_time) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        static bool execute(const std::string& output, const std::string& command) {
+            std::error_code ec;
+            std::filesystem::create_directories(std::filesystem::path(output).parent_path(), ec);
+            std::cout.flush();
+            return std::system(command.c_str()) == 0;
+        }
+
+        static bool run(const std::string& output, const std::string& command) {
+            if (!execute(output, command)) {
+                return false;
+            }
+            write_file(output + ".cmd", command);
+            return true;
+        }
+
+        ////////////////////////////////////////////////////////////
+        //                     Object cache                       //
+        ////////////////////////////////////////////////////////////
+
+        // SHA-256 key, a hit is used without any further check so it must not collide by accident or design.
+        // Every piece is length prefixed so boundaries count.
+        class content_hasher {
+            static constexpr std::uint32_t round_constants_[64] = {
+                0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+                0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+                0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+                0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+                0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+                0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+                0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+                0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+            };
+
+            std::array<std::uint32_t, 8>  state_ = { 0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19 };
+            std::array<unsigned char, 64> block_{};
+            std::uint64_t                 size_ = 0;   // Bytes fed so far.
+
+            void compress() {
+                std::uint32_t w[64];
+                for (std::size_t i = 0; i != 16; ++i) {
+                    w[i] = std::uint32_t(block_[4 * i]) << 24 | std::uint32_t(block_[4 * i + 1]) << 16 | std::uint32_t(block_[4 * i + 2]) << 8 | block_[4 * i + 3];
+                }
+                for (std::size_t i = 16; i != 64; ++i) {
+                    auto s0 = std::rotr(w[i - 15], 7) ^ std::rotr(w[i - 15], 18) ^ (w[i - 15] >> 3);
+                    auto s1 = std::rotr(w[i - 2], 17) ^ std::rotr(w[i - 2], 19) ^ (w[i - 2] >> 10);
+                    w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+                }
+                auto [a, b, c, d, e, f, g, h] = state_;
+                for (std::size_t i = 0; i != 64; ++i) {
+                    auto t1 = h + (std::rotr(e, 6) ^ std::rotr(e, 11) ^ std::rotr(e, 25)) + ((e & f) ^ (~e & g)) + round_constants_[i] + w[i];
+                    auto t2 = (std::rotr(a, 2) ^ std::rotr(a, 13) ^ std::rotr(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+                    h = g; g = f; f = e; e = d + t1;
+                    d = c; c = b; b = a; a = t1 + t2;
+                }
+                std::uint32_t result[] = { a, b, c, d, e, f, g, h };
+                for (std::size_t i = 0; i != 8; ++i) {
+                    state_[i] += result[i];
+                }
+            }
+
+            void feed(std::string_view data) {
+                for (unsigned char c : data) {
+                    block_[size_++ % 64] = c;
+                    if (size_ % 64 == 0) {
+                        compress();
+                    }
+                }
+            }
+        public:
+            content_hasher& update(std::string_view data) {
+                std::uint64_t size = data.size();
+                feed({ reinterpret_cast<const char*>(&size), sizeof(size) });
+                feed(data);
+                return *this;
+            }
+
+            // Entries are spread over 256 sub directories to keep each one small.
+            std::filesystem::path entry() const {
+                content_hasher last = *this;
+                std::uint64_t  bits = size_ * 8;
+                last.feed("\x80");
+                while (last.size_ % 64 != 56) {
+                    last.feed({ "", 1 });
+                }
+                for (int shift = 56; shift >= 0; shift -= 8) {
+                    const char byte = static_cast<char>(bits >> shift);
+                    last.feed({ &byte, 1 });
+                }
+                std::string hex;
+                for (auto word : last.state_) {
+                    hex.append(std::format("{:08x}", word));
+                }
+                return std::filesystem::path(hex.substr(0, 2)) / (hex.substr(2) + ".o");
+            }
+        };
+
+        // MAKEXX_CACHE_DIR overrides the location, set to an empty string it turns the cache off.
+        static std::filesystem::path cache_directory() {
+            if (const char* dir = std::getenv("MAKEXX_CACHE_DIR")) {
+                return dir;
+            }
+            if (const char* xdg = std::getenv("XDG_CACHE_HOME"); xdg && *xdg) {
+                return std::filesystem::path(xdg) / "makexx";
+            }
+            if (const char* home = std::getenv("HOME"); home && *home) {
+                return std::filesystem::path(home) / ".cache" / "makexx";
+            }
+            return {};
+        }
+
+        // MAKEXX_CACHE_SIZE in MiB, 5 GiB by default. A size too large for a byte count means no limit,
+        // anything but a number keeps the default rather than evicting the whole cache.
+        static std::uintmax_t cache_capacity() {
+            constexpr std::uintmax_t max_mib = std::numeric_limits<std::uintmax_t>::max() >> 20;
+            const char*              env     = std::getenv("MAKEXX_CACHE_SIZE");
+            std::string_view         size    = env ? env : "";
+            std::uintmax_t           mib     = 5120;
+            if (!size.empty()) {
+                std::uintmax_t value = 0;
+                auto [end, ec] = std::from_chars(size.data(), size.data() + size.size(), value);
+                if (end != size.data() + size.size() || (ec != std::errc{} && ec != std::errc::result_out_of_range)) {
+                    tiny_print(std::cout, "Warning, MAKEXX_CACHE_SIZE {:s} is not a size in MiB, using {:d}!\n", size, mib);
+                } else {
+                    mib = ec == std::errc::result_out_of_range ? max_mib : std::min(value, max_mib);
+                }
+            }
+            return mib << 20;
+        }
+
+        // Like ccache's default compiler check, the driver found on PATH is identified by its real path, size and mtime.
+        static std::string compiler_identity(std::string_view driver) {
+#ifdef _WIN32
+            constexpr char separator = ';';
+#else
+            constexpr char separator = ':';
+#endif
+            const char*      path_env = std::getenv("PATH");
+            std::string_view paths    = path_env ? path_env : "";
+            for (std::size_t begin = 0, end = 0; begin <= paths.size(); begin = end + 1) {
+                end = std::min(paths.find(separator, begin), paths.size());
+                std::error_code ec;
+                auto candidate = std::filesystem::canonical(std::filesystem::path(paths.substr(begin, end - begin)) / driver, ec);
+                if (ec || !std::filesystem::is_regular_file(candidate, ec)) {
+                    continue;
+                }
+                auto size  = std::filesystem::file_size(candidate, ec);
+                auto mtime = std::filesystem::last_write_time(candidate, ec).time_since_epoch().count();
+                return std::format("{:s}|{:d}|{:d}", candidate.generic_string(), size, static_cast<std::int64_t>(mtime));
+            }
+            return std::string(driver);
+        }
+
+        // A hit copies the entry out and marks it as recently used for eviction.
+        static bool restore_from_cache(const std::filesystem::path& entry, const std::string& object) {
+            std::error_code ec;
+            if (!std::filesystem::copy_file(entry, object, std::filesystem::copy_options::overwrite_existing, ec) || ec) {
+                return false;
+            }
+            std::filesystem::last_write_time(entry, std::filesystem::file_time_type::clock::now(), ec);
+            return true;
+        }
+
+        // Written beside the entry and renamed over it, so concurrent builds never see half an object.
+        static void store_in_cache(const std::filesystem::path& entry, const std::string& object) {
+            std::error_code ec;
+            std::filesystem::create_directories(entry.parent_path(), ec);
+            auto temporary = entry;
+            temporary += std::format(".{:x}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id())
+                ^ static_cast<std::size_t>(std::chrono::steady_clock::now().time_since_epoch().count()));
+            if (std::filesystem::copy_file(object, temporary, ec) && !ec) {
+                std::filesystem::rename(temporary, entry, ec);
+            }
+            if (ec) {
+                std::filesystem::remove(temporary, ec);
+            }
+        }
+
+        // Least recently used entries go first until the cache is back under 90% of its capacity.
+        static std::size_t evict_cache(const std::filesystem::path& dir, std::uintmax_t capacity) {
+            struct cache_entry {
+                std::filesystem::file_time_type  time;
+                std::uintmax_t                   size;
+                std::filesystem::path            path;
+            };
+            std::vector<cache_entry> entries;
+            std::uintmax_t           total = 0;
+            std::error_code          ec;
+            for (auto it = std::filesystem::recursive_directory_iterator(dir, ec); !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+                if (it->is_regular_file(ec)) {
+                    auto& e = entries.emplace_back(cache_entry{ it->last_write_time(ec), it->file_size(ec), it->path() });
+                    total += e.size;
+                }
+            }
+            if (total <= capacity) {
+                return 0;
+            }
+            std::ranges::sort(entries, {}, &cache_entry::time);
+            std::size_t evicted = 0;
+            for (const auto& e : entries) {
+                if (total <= capacity / 10 * 9) {
+                    break;
+                }
+                if (std::filesystem::remove(e.path, ec)) {
+                    total -= e.size;
+                    ++evicted;
+                }
+            }
+            return evicted;
+        }
+    }
+
+
     ////////////////////////////////////////////////////////////
     //            Also belongs to generator                   //
     ////////////////////////////////////////////////////////////
@@ -844,107 +1727,318 @@ if (auto it = current_archive.find_variable_begin<decltype(fn)>(#fn); it != curr
         return generator_details::unwrap_shrunk_paths(paths);
     }
     
-    void makexx::make_application::read_target_and_generate_vs_project_(const std::string& target, const std::string& source, visual_studio_project& vssln) {
-        std::stringstream strbuf;
-        tiny_print(strbuf, "{:s}\n#pragma target_config end", source);
-
-#define FIND_AND_SET_PROPERTY(fn, hd, ...) do { \
-if (auto it = current_archive.find_variable_begin<decltype(mxx_##fn)>("mxx_"#fn); it != current_archive.content_end()) {\
-    cpod::serializer<decltype(mxx_##fn)>{}(it, mxx_##fn, 0); \
-    auto hd_var = hd(mxx_##fn);                          \
-    vssln.fn(target, hd_var,##__VA_ARGS__);           \
-}} while (false)
+    // Reads the target scope when config is empty, otherwise the config::mxx_target_* records of one config namespace.
+    void makexx::make_application::read_target_properties_(cpod::archive& current_archive, const std::string& config, target_properties& props) {
+        const std::string scope = config.empty() ? std::string() : config + "::";
+
+#define FIND_AND_GET_TARGET_PROPERTY(obj, field) \
+generator_details::find_and_get_target_property(current_archive, scope + "mxx_target_"#field, obj.field)
+
+        const auto& root = definition_map_["MXX_PROJECT_ROOT"];
+        if (config.empty()) {
+            FIND_AND_GET_TARGET_PROPERTY(props, headers);
+            FIND_AND_GET_TARGET_PROPERTY(props, sources);
+            FIND_AND_GET_TARGET_PROPERTY(props, dependencies);
+            FIND_AND_GET_TARGET_PROPERTY(props, external_link_directories);
+            FIND_AND_GET_TARGET_PROPERTY(props, external_include_directories);
+            FIND_AND_GET_TARGET_PROPERTY(props, public_include_directories);
+            FIND_AND_GET_TARGET_PROPERTY(props, public_defines);
+            FIND_AND_GET_TARGET_PROPERTY(props, public_external_links);
+            FIND_AND_GET_TARGET_PROPERTY(props, msvc_icon);
+            FIND_AND_GET_TARGET_PROPERTY(props, pch_header);
+            FIND_AND_GET_TARGET_PROPERTY(props, pch_source);
+            FIND_AND_GET_TARGET_PROPERTY(props, type);
+            FIND_AND_GET_TARGET_PROPERTY(props, std_cpp);
+            FIND_AND_GET_TARGET_PROPERTY(props, std_c);
+            FIND_AND_GET_TARGET_PROPERTY(props, msvc_subsystem);
+            FIND_AND_GET_TARGET_PROPERTY(props, unity_build);
+            FIND_AND_GET_TARGET_PROPERTY(props, msvc_multiprocessor);
+            FIND_AND_GET_TARGET_PROPERTY(props, msvc_codegen_threads);
+
+            // Paths are made absolute here so no generator has to know the project root.
+            props.headers                      = fix_paths_(props.headers, root);
+            props.sources                      = fix_paths_(props.sources, root);
+            props.external_link_directories    = fix_paths_(props.external_link_directories, root);
+            props.external_include_directories = fix_paths_(props.external_include_directories, root);
+            props.public_include_directories   = fix_paths_(props.public_include_directories, root);
+            if (!props.msvc_icon.empty())  { props.msvc_icon  = fix_path_(props.msvc_icon, root); }
+            if (!props.pch_source.empty()) { props.pch_source = fix_path_(props.pch_source, root); }
+        }
+        else {
+            auto& target_config = props.configs.emplace_back();
+            target_config.name = config;
+            FIND_AND_GET_TARGET_PROPERTY(target_config, defines);
+            FIND_AND_GET_TARGET_PROPERTY(target_config, external_links);
+            FIND_AND_GET_TARGET_PROPERTY(target_config, binary_directory);
+            FIND_AND_GET_TARGET_PROPERTY(target_config, intermediate_directory);
+            FIND_AND_GET_TARGET_PROPERTY(target_config, optimization);
+            FIND_AND_GET_TARGET_PROPERTY(target_config, instruction_set);
+            FIND_AND_GET_TARGET_PROPERTY(target_config, lto);
+            FIND_AND_GET_TARGET_PROPERTY(target_config, pgo_phase);
+            FIND_AND_GET_TARGET_PROPERTY(target_config, msvc_incremental_link);
+            FIND_AND_GET_TARGET_PROPERTY(target_config, msvc_debug_fastlink);
+
+            if (!target_config.binary_directory.empty())       { target_config.binary_directory       = fix_path_(target_config.binary_directory, root); }
+            if (!target_config.intermediate_directory.empty()) { target_config.intermediate_directory = fix_path_(target_config.intermediate_directory, root); }
+        }
+#undef FIND_AND_GET_TARGET_PROPERTY
+    }
+
+    bool make_application::read_all_target_properties_() {
+        // Every target is an independent section, they are compiled all at once.
+        std::vector<cpod::archive::section>      sections;
+        std::vector<const project_description*>  owners;   // Description of each target, in PROJECT_TARGETS order.
+        for (auto& description : mxx_project_descriptions_) {
+            for (const auto& target : description.targets) {
+                sections.push_back({ cpod::archive(description.includes + description.source_fields[target]), {}, {} });
+                owners.push_back(&description);
+            }
+        }
 
+        cpod::archive::compile_many(sections, definition_map_, 0, include_cache_.get(), &compile_upstream_);
 
-#define FIND_AND_SET_PROPERTY_EX(fn, hd, q, ...) do { \
-if (auto it = current_archive.find_variable_begin<decltype(mxx_##fn)>("mxx_"#fn); it != current_archive.content_end()) {\
-cpod::serializer<decltype(mxx_##fn)>{}(it, mxx_##fn, 0); \
-auto hd_var = hd(mxx_##fn, q);                          \
-vssln.fn(target, hd_var,##__VA_ARGS__);           \
-}} while (false)
-        
-        std::string      splited_source;
-        std::size_t      config_count = 0;
-        std::string      current_config;
-        
-        for (std::string line_cache; std::getline(strbuf, line_cache);) {
-            if (std::memcmp(line_cache.c_str(), "#pragma target_config ", 22) == 0) {
-                cpod::archive    current_archive(splited_source);
-                current_archive.compile_content_default(definition_map_);
-                if (config_count == 0) {
-                    // Variables needed to be loaded.
-                    std::vector<std::string> mxx_target_headers;
-                    std::vector<std::string> mxx_target_sources;
-                    std::vector<std::string> mxx_target_dependencies;
-                    std::vector<std::string> mxx_target_external_link_directories;
-                    std::vector<std::string> mxx_target_external_include_directories;
-
-                    std::string              mxx_target_msvc_icon;
-                    std::uint32_t            mxx_target_type;
-                    std::uint32_t            mxx_target_std_cpp;
-                    std::uint32_t            mxx_target_std_c;
-                    std::uint32_t            mxx_target_msvc_subsystem;
-
-                    auto filter_root = fix_path_("", definition_map_["MXX_PROJECT_ROOT"]);
-                    
-                    FIND_AND_SET_PROPERTY_EX(target_sources,                        fix_paths_, definition_map_["MXX_PROJECT_ROOT"], filter_root);
-                    FIND_AND_SET_PROPERTY_EX(target_headers,                        fix_paths_, definition_map_["MXX_PROJECT_ROOT"], filter_root);
-                    FIND_AND_SET_PROPERTY_EX(target_msvc_icon,                      fix_path_ , definition_map_["MXX_PROJECT_ROOT"]);
-                    FIND_AND_SET_PROPERTY   (target_dependencies,                   generator_details::no_operation);
-                    FIND_AND_SET_PROPERTY   (target_type,                           generator_details::enum_convert<target_types>);
-                    FIND_AND_SET_PROPERTY   (target_std_cpp,                        generator_details::enum_convert<target_cpp_standards>);
-                    FIND_AND_SET_PROPERTY   (target_std_c,                          generator_details::enum_convert<target_c_standards>);
-                    FIND_AND_SET_PROPERTY   (target_msvc_subsystem,                 generator_details::enum_convert<target_msvc_subsystems>);
-                    FIND_AND_SET_PROPERTY_EX(target_external_link_directories,      fix_paths_, definition_map_["MXX_PROJECT_ROOT"]);
-                    FIND_AND_SET_PROPERTY_EX(target_external_include_directories,   fix_paths_, definition_map_["MXX_PROJECT_ROOT"]);
-                    ++config_count;
+        // All sections report before giving up, so one run lists every error.
+        bool clean = true;
+        for (const auto& section : sections) {
+            clean = report_diagnostics_(section.diagnostics) && clean;
+        }
+        // Nothing reads a namespace that is not a configuration, its properties would be dropped silently.
+        for (std::size_t i = 0; i < sections.size(); ++i) {
+            for (const auto& scope : sections[i].namespaces) {
+                if (std::ranges::find(owners[i]->configurations, scope) == owners[i]->configurations.end()) {
+                    tiny_print(std::cout, "Error, namespace {:s} of target {:s} in {:s} is not declared in PROJECT_CONFIGURATIONS!\n",
+                        scope, mxx_project_targets[i], owners[i]->path);
+                    clean = false;
                 }
-                else {
-                    // Means the config we use is not available.
-                    if (std::ranges::find(mxx_project_configurations, current_config) == mxx_project_configurations.end()) {
-                        tiny_print(std::cout, "You are defining a configuration namespace that has not declared in PROJECT_CONFIGURATIONS!\n");
-                    }
-                    
-                    std::vector<std::string> mxx_target_defines;
-                    std::vector<std::string> mxx_target_external_links;
-                    std::string              mxx_target_binary_directory;
-                    std::string              mxx_target_intermediate_directory;
-                    std::uint32_t            mxx_target_optimization;
-                    
-                    FIND_AND_SET_PROPERTY(target_optimization,            generator_details::enum_convert<target_optimizations>, current_config);
-                    FIND_AND_SET_PROPERTY(target_defines,                 generator_details::no_operation,                       current_config);
-                    FIND_AND_SET_PROPERTY(target_external_links,          generator_details::no_operation,                       current_config);
-                    FIND_AND_SET_PROPERTY_EX(target_intermediate_directory,  fix_path_, definition_map_["MXX_PROJECT_ROOT"],     current_config);
-                    FIND_AND_SET_PROPERTY_EX(target_binary_directory,        fix_path_, definition_map_["MXX_PROJECT_ROOT"],     current_config);
-                    ++config_count;
-                }
-                splited_source.clear();
-                current_config = line_cache.substr(22);
-            } else {
-                splited_source.append(line_cache);
-                splited_source.push_back('\n');
             }
         }
-        
+        if (!clean) {
+            return false;
+        }
+
+        mxx_project_target_properties_.assign(mxx_project_targets.size(), {});
+        for (std::size_t i = 0; i < mxx_project_targets.size(); ++i) {
+            auto& props = mxx_project_target_properties_[i];
+            props.name = mxx_project_targets[i];
+            read_target_properties_(sections[i].arch, {}, props);
+            for (const auto& config : sections[i].namespaces) {
+                read_target_properties_(sections[i].arch, config, props);
+            }
+            if (!props.pch_header.empty() && props.pch_source.empty()) {
+                tiny_print(std::cout, "Error, target {:s} sets TARGET_PCH_HEADER without TARGET_PCH_SOURCE to create it!\n", props.name);
+                clean = false;
+            }
+        }
+        return clean;
     }
 
-    void make_application::generate_actual_visual_studio_project_() {
-        read_source_and_split_targets_();
+    bool make_application::build_target_graph_() {
+        auto&       targets = mxx_project_target_properties_;
+        auto&       graph   = mxx_project_graph_;
+        std::size_t n       = targets.size();
+        graph = {};
+        graph.dependencies.resize(n);
+        graph.dependents.resize(n);
+        graph.depth.assign(n, 0);
+
+        std::unordered_map<std::string_view, std::size_t> index_of;
+        for (std::size_t i = 0; i < n; ++i) {
+            index_of.emplace(targets[i].name, i);
+        }
+        for (std::size_t i = 0; i < n; ++i) {
+            for (const auto& dependency : targets[i].dependencies) {
+                auto it = index_of.find(dependency);
+                if (it == index_of.end()) {
+                    tiny_print(std::cout, "Error, target {:s} depends on {:s} which is not in PROJECT_TARGETS!\n", targets[i].name, dependency);
+                    return false;
+                }
+                graph.dependencies[i].push_back(it->second);
+                graph.dependents[it->second].push_back(i);
+            }
+        }
+
+        // Depth first, a target is ordered after all its dependencies, reaching one still on the stack is a cycle.
+        std::vector<std::uint8_t> marks(n);   // 1 is on the stack, 2 is ordered
+        std::vector<std::size_t>  stack;
+        auto visit = [&](auto& self, std::size_t i) -> bool {
+            if (marks[i] == 2) {
+                return true;
+            }
+            if (marks[i] == 1) {
+                std::string cycle;
+                for (auto it = std::ranges::find(stack, i); it != stack.end(); ++it) {
+                    cycle.append(targets[*it].name).append(" -> ");
+                }
+                tiny_print(std::cout, "Error, TARGET_DEPENDENCIES form a cycle: {:s}{:s}!\n", cycle, targets[i].name);
+                return false;
+            }
+            marks[i] = 1;
+            stack.push_back(i);
+            for (auto dependency : graph.dependencies[i]) {
+                if (!self(self, dependency)) {
+                    return false;
+                }
+                graph.depth[i] = std::max(graph.depth[i], graph.depth[dependency]);
+            }
+            ++graph.depth[i];
+            stack.pop_back();
+            marks[i] = 2;
+            graph.order.push_back(i);
+            return true;
+        };
+        for (std::size_t i = 0; i < n; ++i) {
+            if (!visit(visit, i)) {
+                return false;
+            }
+        }
+
+        // Walks back from the deepest target, each step to a dependency exactly one level lower.
+        if (n > 0) {
+            auto i = static_cast<std::size_t>(std::ranges::max_element(graph.depth) - graph.depth.begin());
+            for (;;) {
+                graph.critical_path.push_back(i);
+                auto next = std::ranges::find_if(graph.dependencies[i], [&](auto d) { return graph.depth[d] + 1 == graph.depth[i]; });
+                if (next == graph.dependencies[i].end()) {
+                    break;
+                }
+                i = *next;
+            }
+            std::ranges::reverse(graph.critical_path);
+        }
+
+        // Only with --profile, -gc output is parsed by tools.
+        if (profile_) {
+            std::string path;
+            for (auto i : graph.critical_path) {
+                path.append(path.empty() ? "" : " -> ").append(targets[i].name);
+            }
+            tiny_print(std::cout, "Target graph has {:d} targets, critical path of {:d}: {:s}\n", n, graph.critical_path.size(), path);
+        }
+        return true;
+    }
+
+    // What a target passes on is its own public part followed by what its dependencies pass on.
+    // Targets are visited in graph order, so every one is merged exactly once from memoized results.
+    void make_application::resolve_usage_requirements_() {
+        struct usage_requirements {
+            std::vector<std::string> include_directories;
+            std::vector<std::string> defines;
+            std::vector<std::string> external_links;
+        };
+        auto append_unique = [](std::vector<std::string>& to, const std::vector<std::string>& from) {
+            if (from.empty()) {
+                return;
+            }
+            // Reserved first, so the views stay valid while pushing.
+            to.reserve(to.size() + from.size());
+            std::unordered_set<std::string_view> seen(to.begin(), to.end());
+            for (const auto& value : from) {
+                if (seen.insert(value).second) {
+                    to.push_back(value);
+                }
+            }
+        };
+
+        auto& targets = mxx_project_target_properties_;
+        auto& graph   = mxx_project_graph_;
+        std::vector<usage_requirements> interfaces(targets.size());
+        for (auto t : graph.order) {
+            auto& usage = interfaces[t];
+            usage = { targets[t].public_include_directories, targets[t].public_defines, targets[t].public_external_links };
+            for (auto dependency : graph.dependencies[t]) {
+                append_unique(usage.include_directories, interfaces[dependency].include_directories);
+                append_unique(usage.defines,             interfaces[dependency].defines);
+                append_unique(usage.external_links,      interfaces[dependency].external_links);
+            }
+        }
+
+        for (std::size_t t = 0; t < targets.size(); ++t) {
+            auto& props = targets[t];
+            auto& usage = interfaces[t];
+            append_unique(props.external_include_directories, usage.include_directories);
+            if (usage.defines.empty() && usage.external_links.empty()) {
+                continue;
+            }
+            // Defines and links are per configuration, a configuration without a namespace still gets them.
+            for (const auto& name : mxx_project_configurations) {
+                auto it = std::ranges::find(props.configs, name, &target_config_properties::name);
+                if (it == props.configs.end()) {
+                    it = props.configs.insert(props.configs.end(), target_config_properties{});
+                    it->name = name;
+                }
+                auto& config = *it;
+                append_unique(config.defines,        usage.defines);
+                append_unique(config.external_links, usage.external_links);
+            }
+        }
+    }
+
+    void make_application::generate_vs_target_(const target_properties& props, visual_studio_project& vssln) {
+        const auto& target      = props.name;
+        auto        filter_root = fix_path_("", definition_map_["MXX_PROJECT_ROOT"]);
+
+        if (!props.sources.empty())              { vssln.target_sources(target, props.sources, filter_root); }
+        if (!props.headers.empty())              { vssln.target_headers(target, props.headers, filter_root); }
+        if (!props.msvc_icon.empty())            { vssln.target_msvc_icon(target, props.msvc_icon); }
+        if (!props.dependencies.empty())         { vssln.target_dependencies(target, props.dependencies); }
+        if (props.type)                          { vssln.target_type(target, *props.type); }
+        if (props.std_cpp)                       { vssln.target_std_cpp(target, *props.std_cpp); }
+        if (props.std_c)                         { vssln.target_std_c(target, *props.std_c); }
+        if (props.msvc_subsystem)                { vssln.target_msvc_subsystem(target, *props.msvc_subsystem); }
+        if (props.unity_build)                   { vssln.target_unity_build(target, *props.unity_build); }
+        if (props.msvc_multiprocessor)           { vssln.target_msvc_multiprocessor(target, *props.msvc_multiprocessor); }
+        if (props.msvc_codegen_threads)          { vssln.target_msvc_codegen_threads(target, *props.msvc_codegen_threads); }
+        if (!props.pch_header.empty())           { vssln.target_precompiled_header(target, props.pch_header, props.pch_source); }
+        if (!props.external_link_directories.empty())    { vssln.target_external_link_directories(target, props.external_link_directories); }
+        if (!props.external_include_directories.empty()) { vssln.target_external_include_directories(target, props.external_include_directories); }
+
+        for (const auto& config : props.configs) {
+            if (config.optimization)                    { vssln.target_optimization(target, *config.optimization, config.name); }
+            if (!config.defines.empty())                { vssln.target_defines(target, config.defines, config.name); }
+            if (!config.external_links.empty())         { vssln.target_external_links(target, config.external_links, config.name); }
+            if (!config.intermediate_directory.empty()) { vssln.target_intermediate_directory(target, config.intermediate_directory, config.name); }
+            if (!config.binary_directory.empty())       { vssln.target_binary_directory(target, config.binary_directory, config.name); }
+            if (config.instruction_set)                 { vssln.target_instruction_set(target, *config.instruction_set, config.name); }
+            if (config.lto)                             { vssln.target_lto(target, *config.lto, config.name); }
+            if (config.pgo_phase)                       { vssln.target_pgo_phase(target, *config.pgo_phase, config.name); }
+            if (config.msvc_incremental_link)           { vssln.target_msvc_incremental_link(target, *config.msvc_incremental_link, config.name); }
+            if (config.msvc_debug_fastlink)             { vssln.target_msvc_debug_fastlink(target, *config.msvc_debug_fastlink, config.name); }
+        }
+    }
+
+    bool make_application::generate_actual_visual_studio_project_() {
+        if (argc_ < 3) {
+            tiny_print(std::cout, "Error, must have project description path argument!\n");
+            return false;
+        }
+        std::vector<std::string> description_paths;
+        for (int i = 2; i < argc_; ++i) {
+            if (!collect_description_paths_(argv_[i], description_paths)) {
+                return false;
+            }
+        }
+        if (!read_source_and_split_targets_(description_paths) || !read_all_target_properties_() || !build_target_graph_()) {
+            return false;
+        }
+        resolve_usage_requirements_();
+        std::string joined_paths;
+        for (const auto& path : description_paths) {
+            joined_paths.append(joined_paths.empty() ? "" : ", ").append(path);
+        }
         tiny_print(std::cout,
             "----------------------------------------------------------------------------------------------\n"
         "Makepluplus project descriptor {:s} parsing complete!\n"
-        "Generating project using \"Visual Studio Generator\"!\n", argv_[2]);
+        "Generating project using \"Visual Studio Generator\"!\n", joined_paths);
         
-        visual_studio_project vssln(mxx_project_name, mxx_project_configurations);
+        visual_studio_project vssln(mxx_project_name, mxx_project_configurations, &arena_requests_);
     
         for (auto& target : mxx_project_targets) {
             vssln.new_target(target);
         }
         
-        for (auto& target : mxx_project_targets) {
-            auto& source = mxx_project_source_fields_[target];
-            read_target_and_generate_vs_project_(target, source, vssln);
-            tiny_print(std::cout, "VC++ Project {:s} generated!\n", target);
+        for (auto& props : mxx_project_target_properties_) {
+            generate_vs_target_(props, vssln);
+            tiny_print(std::cout, "VC++ Project {:s} generated!\n", props.name);
         }
     
         std::filesystem::create_directory(mxx_project_name);
@@ -953,31 +2047,329 @@ vssln.fn(target, hd_var,##__VA_ARGS__);           \
     
         tiny_print(std::cout, "Visual Studio Solution {:s} generated!\n"
             "----------------------------------------------------------------------------------------------\n",mxx_project_name);
+        return true;
     }
 
-    make_application::make_application(int argc, char** argv) : argc_(argc), argv_(argv) {
+    bool make_application::read_targets_for_configuration_(std::string& config) {
+        if (argc_ < 3) {
+            tiny_print(std::cout, "Error, must have project description path argument!\n");
+            return false;
+        }
+        std::vector<std::string> description_paths;
+        if (!collect_description_paths_(argv_[2], description_paths) || !read_source_and_split_targets_(description_paths)) {
+            return false;
+        }
+        if (mxx_project_configurations.empty()) {
+            tiny_print(std::cout, "Error, no configuration declared in PROJECT_CONFIGURATIONS!\n");
+            return false;
+        }
+        config = argc_ > 3 ? argv_[3] : mxx_project_configurations.front();
+        if (std::ranges::find(mxx_project_configurations, config) == mxx_project_configurations.end()) {
+            tiny_print(std::cout, "Error, configuration {:s} is not declared in PROJECT_CONFIGURATIONS!\n", config);
+            return false;
+        }
+        if (!read_all_target_properties_() || !build_target_graph_()) {
+            return false;
+        }
+        resolve_usage_requirements_();
+        // Precompiled headers and unity builds only exist in the Visual Studio projects, the build would differ silently otherwise.
+        for (const auto& props : mxx_project_target_properties_) {
+            if (!props.pch_header.empty()) {
+                tiny_print(std::cout, "Warning, TARGET_PCH_HEADER of target {:s} is ignored by -b and -gc, only -gv uses it!\n", props.name);
+            }
+            if (props.unity_build.value_or(0) != 0) {
+                tiny_print(std::cout, "Warning, TARGET_UNITY_BUILD of target {:s} is ignored by -b and -gc, only -gv uses it!\n", props.name);
+            }
+        }
+        return true;
+    }
+
+    bool make_application::generate_compile_database_() {
+        std::string config;
+        if (!read_targets_for_configuration_(config)) {
+            return false;
+        }
+        auto root = fix_path_("", definition_map_["MXX_PROJECT_ROOT"]);
+        auto& targets = mxx_project_target_properties_;
+        auto  pic     = gcc_details::position_independent_targets(targets, mxx_project_graph_);
+
+        // Every target renders into its own buffer, the buffers are streamed out in target order afterwards.
+        std::vector<std::string>  fragments(targets.size());
+        generator_details::parallel_for(targets.size(), [&](std::size_t i) {
+            fragments[i] = gcc_details::compile_commands_of(targets[i], config, root, pic[i]);
+        });
+
+        std::ofstream database(std::filesystem::path(root) / "compile_commands.json");
+        bool first = true;
+        database.rdbuf()->sputn("[", 1);
+        for (const auto& fragment : fragments) {
+            if (fragment.empty()) {
+                continue;
+            }
+            database.rdbuf()->sputn(first ? "\n" : ",\n", first ? 1 : 2);
+            database.rdbuf()->sputn(fragment.data(), fragment.size());
+            first = false;
+        }
+        database.rdbuf()->sputn("\n]\n", 3);
+        database.close();
+
+        tiny_print(std::cout, "Compilation database for {:s} written to {:s}compile_commands.json!\n", config, root);
+        return true;
+    }
+
+    int make_application::build_project_() {
+        std::string config;
+        if (!read_targets_for_configuration_(config)) {
+            return 1;
+        }
+        auto        root    = fix_path_("", definition_map_["MXX_PROJECT_ROOT"]);
+        auto&       targets = mxx_project_target_properties_;
+        const auto& graph   = mxx_project_graph_;
+
+        // Translation units do not depend on other targets, so all of them are compiled in one parallel pass.
+        struct compile_job {
+            std::string source;
+            std::string object;
+            std::string command;
+            std::string preprocess;   // Same flags with -E, also refreshes the depfile.
+            std::string flags;        // Everything but the output paths, part of the cache key.
+            std::string driver;
+        };
+        std::vector<compile_job>               jobs;
+        std::vector<std::vector<std::string>>  objects(targets.size());
+        auto                                   pic = gcc_details::position_independent_targets(targets, graph);
+        for (auto t : graph.order) {
+            auto cfg    = gcc_details::find_config(targets[t], config);
+            auto common = gcc_details::common_arguments(targets[t], cfg, config, pic[t]);
+            for (const auto& source : targets[t].sources) {
+                auto object     = gcc_details::object_path(targets[t], cfg, config, source, root);
+                auto args       = gcc_details::compile_arguments(targets[t], common, source, object);
+                auto preprocess = gcc_details::compile_arguments(targets[t], common, source, object + ".i");
+                auto flags      = build_details::join_command(gcc_details::compile_arguments(targets[t], common, source, ""));
+                std::ranges::replace(preprocess, std::string("-c"), std::string("-E"));
+                args.insert(args.end(), { "-MMD", "-MF", object + ".d" });
+                preprocess.insert(preprocess.end(), { "-MMD", "-MF", object + ".d" });
+                objects[t].push_back(object);
+                jobs.push_back({ source, object, build_details::join_command(args), build_details::join_command(preprocess), std::move(flags), args.front() });
+            }
+        }
+
+        auto cache_dir = build_details::cache_directory();
+        std::unordered_map<std::string, std::string> identities;
+        if (!cache_dir.empty()) {
+            for (const auto& job : jobs) {
+                if (!identities.contains(job.driver)) {
+                    identities[job.driver] = build_details::compiler_identity(job.driver);
+                }
+            }
+        }
+
+        std::atomic<bool>         failed   = false;
+        std::atomic<std::size_t>  compiled = 0;
+        std::atomic<std::size_t>  hits     = 0;
+        std::atomic<std::size_t>  misses   = 0;
+        std::mutex                print_mutex;
+        generator_details::parallel_for(jobs.size(), [&](std::size_t i) {
+            if (failed) {
+                return;
+            }
+            auto& job    = jobs[i];
+            auto  inputs = build_details::parse_depfile(job.object + ".d");
+            inputs.push_back(job.source);
+            if (build_details::is_up_to_date(job.object, inputs, job.command)) {
+                return;
+            }
+
+            // Preprocessing is much cheaper than compiling, its output decides whether the object is already known.
+            std::filesystem::path entry;
+            if (!cache_dir.empty()) {
+                auto preprocessed = job.object + ".i";
+                if (build_details::execute(preprocessed, job.preprocess)) {
+                    entry = cache_dir / build_details::content_hasher{}.update(identities.at(job.driver)).update(job.flags)
+                        .update(build_details::read_file(preprocessed)).entry();
+                }
+                std::error_code ec;
+                std::filesystem::remove(preprocessed, ec);
+                if (!entry.empty() && build_details::restore_from_cache(entry, job.object)) {
+                    build_details::write_file(job.object + ".cmd", job.command);
+                    ++hits;
+                    std::lock_guard lock(print_mutex);
+                    tiny_print(std::cout, "[{:d}/{:d}] Cached    {:s}\n", i + 1, jobs.size(), job.source);
+                    return;
+                }
+                ++misses;
+            }
+            {
+                std::lock_guard lock(print_mutex);
+                tiny_print(std::cout, "[{:d}/{:d}] Compiling {:s}\n", i + 1, jobs.size(), job.source);
+            }
+            if (!build_details::run(job.object, job.command)) {
+                failed = true;
+                std::lock_guard lock(print_mutex);
+                tiny_print(std::cout, "Error, failed to compile {:s}!\n", job.source);
+                return;
+            }
+            if (!entry.empty()) {
+                build_details::store_in_cache(entry, job.object);
+            }
+            ++compiled;
+        });
+        cache_hits_   = hits;
+        cache_misses_ = misses;
+        if (misses > 0) {
+            cache_evictions_ = build_details::evict_cache(cache_dir, build_details::cache_capacity());
+        }
+        if (failed) {
+            return 1;
+        }
+
+        std::vector<std::string> binaries(targets.size());
+        for (std::size_t t = 0; t < targets.size(); ++t) {
+            binaries[t] = gcc_details::binary_path(targets[t], gcc_details::find_config(targets[t], config), config, root);
+        }
+
+        // Targets of equal depth never depend on each other, each level links in parallel once the one below is done.
+        std::vector<std::vector<std::size_t>> levels;
+        for (auto t : graph.order) {
+            levels.resize(std::max(levels.size(), graph.depth[t]));
+            levels[graph.depth[t] - 1].push_back(t);
+        }
+        std::atomic<std::size_t> linked = 0;
+        auto link_target = [&](std::size_t t) {
+            auto& props  = targets[t];
+            auto  cfg    = gcc_details::find_config(props, config);
+            auto  type   = props.type.value_or(target_types::exe);
+            auto  inputs = objects[t];
+
+            std::vector<std::string> args;
+            if (type == target_types::lib) {
+                args = { "ar", "rcs", binaries[t] };
+                args.insert(args.end(), objects[t].begin(), objects[t].end());
+            }
+            else {
+                args = { "c++" };
+                if (type == target_types::dll)                                   { args.emplace_back("-shared"); }
+                if (cfg && cfg->lto && *cfg->lto)                                { args.emplace_back("-flto"); }
+                if (cfg && cfg->pgo_phase && *cfg->pgo_phase != target_pgo_phases::none) { args.emplace_back(gcc_details::get_pgo_string(*cfg->pgo_phase)); }
+                args.insert(args.end(), objects[t].begin(), objects[t].end());
+
+                // A static library is followed by its own dependencies, a shared one already carries them.
+                std::vector<std::size_t>  link_order;
+                std::vector<std::uint8_t> seen(targets.size());
+                auto collect = [&](auto& self, std::size_t i) -> void {
+                    for (auto dependency : graph.dependencies[i]) {
+                        if (seen[dependency]) {
+                            continue;
+                        }
+                        seen[dependency] = 1;
+                        if (targets[dependency].type.value_or(target_types::exe) == target_types::lib) {
+                            self(self, dependency);
+                        }
+                        link_order.push_back(dependency);
+                    }
+                };
+                collect(collect, t);
+                for (auto dependency : link_order | std::views::reverse) {
+                    if (targets[dependency].type.value_or(target_types::exe) != target_types::exe) {
+                        args.push_back(binaries[dependency]);
+                        inputs.push_back(binaries[dependency]);
+                    }
+                }
+                for (const auto& dir : props.external_link_directories) {
+                    args.emplace_back("-L" + dir);
+                }
+                if (cfg) {
+                    for (const auto& link : cfg->external_links) {
+                        args.emplace_back("-l" + link);
+                    }
+                }
+                args.insert(args.end(), { "-o", binaries[t] });
+            }
+
+            auto command = build_details::join_command(args);
+            if (build_details::is_up_to_date(binaries[t], inputs, command)) {
+                return;
+            }
+            {
+                std::lock_guard lock(print_mutex);
+                tiny_print(std::cout, "Linking {:s}\n", binaries[t]);
+            }
+            if (type == target_types::lib) {
+                // ar only adds members, a stale archive would keep objects of removed sources.
+                std::error_code ec;
+                std::filesystem::remove(binaries[t], ec);
+            }
+            if (!build_details::run(binaries[t], command)) {
+                failed = true;
+                std::lock_guard lock(print_mutex);
+                tiny_print(std::cout, "Error, failed to link {:s}!\n", props.name);
+                return;
+            }
+            ++linked;
+        };
+        for (const auto& level : levels) {
+            generator_details::parallel_for(level.size(), [&](std::size_t i) { link_target(level[i]); });
+            if (failed) {
+                return 1;
+            }
+        }
+
+        tiny_print(std::cout, "Build of {:s} finished, {:d} of {:d} translation units compiled, {:d} from cache, {:d} of {:d} targets linked!\n",
+            config, compiled.load(), jobs.size(), hits.load(), linked.load(), targets.size());
+        return 0;
+    }
+
+    make_application::make_application(int argc, char** argv)
+    : argc_(argc), argv_(argv), arena_upstream_(), arena_(1 << 20, &arena_upstream_), arena_requests_(&arena_),
+      definition_holder_(&arena_requests_) {
+    }
+
+    void make_application::print_profile_() const {
+        tiny_print(std::cout,
+            "----------------------------------------------------------------------------------------------\n"
+            "Arena served {:d} allocations ({:d} bytes) with {:d} upstream heap allocations ({:d} bytes).\n"
+            "Compiler worker pools took {:d} heap allocations ({:d} bytes).\n"
+            "----------------------------------------------------------------------------------------------\n",
+            arena_requests_.allocations(), arena_requests_.bytes(), arena_upstream_.allocations(), arena_upstream_.bytes(),
+            compile_upstream_.allocations(), compile_upstream_.bytes());
+        if (cache_hits_ + cache_misses_ > 0) {
+            tiny_print(std::cout,
+                "Object cache had {:d} hits and {:d} misses, {:d} entries evicted.\n"
+                "----------------------------------------------------------------------------------------------\n",
+                cache_hits_, cache_misses_, cache_evictions_);
+        }
     }
 
     int make_application::operator()() {
         using namespace std::string_view_literals;
+        if (argc_ > 1 && "--profile"sv == argv_[argc_ - 1]) {
+            profile_ = true;
+            --argc_;
+        }
         if (argc_ == 1) {
             tiny_print(std::cout, s_hello_message);
             return 0;
         }
+        int exit_code = 0;
         // Generate project
         if      ("-gh"sv    == argv_[1])    { generate_header_(); }
         else if ("-gp"sv    == argv_[1])    { generate_project_(); }
         else if ("-gv"sv    == argv_[1])    { 
 #ifdef _MSC_VER    
-            generate_actual_visual_studio_project_(); 
+            exit_code = generate_actual_visual_studio_project_() ? 0 : 1;
 #else
-            tiny_print(std::cout, "This is not a MSVC generate program, use -gm for makefile generation!\n");
+            tiny_print(std::cout, "This is not a MSVC generate program, use -b to build directly or -gc for a compilation database!\n");
 #endif
         }
+        else if ("-gc"sv    == argv_[1])    { exit_code = generate_compile_database_() ? 0 : 1; }
+        else if ("-b"sv     == argv_[1])    { exit_code = build_project_(); }
         else if ("-h"sv     == argv_[1]  ||
                  "--help"sv == argv_[1])    {
             tiny_print(std::cout, "{:s}\n", s_help_message);
         }
-        return 0;
+        if (profile_) {
+            print_profile_();
+        }
+        return exit_code;
     }
 }
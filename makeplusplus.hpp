@@ -6,9 +6,14 @@
 
 #include <unordered_map>
 #include <vector>
+#include <deque>
 #include <string>
 #include <format>
 #include <ostream>
+#include <memory_resource>
+#include <atomic>
+#include <optional>
+#include <memory>
 #include "xmloxx.hpp"
 
 namespace msvc_xml {
@@ -18,6 +23,7 @@ namespace msvc_xml {
 
 namespace cpod {
     class archive;
+    class include_cache;
 }
 
 namespace makexx {
@@ -30,20 +36,145 @@ namespace makexx {
         f.rdbuf()->sputn(buf.data(), buf.size());
     }
 
+    // Forwards to upstream and counts what passes through, used by --profile.
+    // The counters are atomic, so it is as thread-safe as its upstream.
+    class counting_memory_resource : public std::pmr::memory_resource {
+        std::pmr::memory_resource*  upstream_;
+        std::atomic<std::size_t>    allocations_ = 0;
+        std::atomic<std::size_t>    bytes_       = 0;
+
+        void* do_allocate(std::size_t bytes, std::size_t alignment) override {
+            allocations_.fetch_add(1, std::memory_order_relaxed);
+            bytes_.fetch_add(bytes, std::memory_order_relaxed);
+            return upstream_->allocate(bytes, alignment);
+        }
+        void  do_deallocate(void* p, std::size_t bytes, std::size_t alignment) override {
+            upstream_->deallocate(p, bytes, alignment);
+        }
+        bool  do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+            return this == &other;
+        }
+    public:
+        explicit counting_memory_resource(std::pmr::memory_resource* upstream = std::pmr::new_delete_resource())
+        : upstream_(upstream) {}
+
+        std::size_t allocations() const { return allocations_.load(std::memory_order_relaxed); }
+        std::size_t bytes()       const { return bytes_.load(std::memory_order_relaxed); }
+    };
+
     enum class target_types             : std::uint32_t { exe     = 1, lib, dll };
     enum class target_cpp_standards     : std::uint32_t { latest  = 1, cpp11, cpp14, cpp17, cpp20, cpp23, cpp26, };
     enum class target_c_standards       : std::uint32_t { latest  = 1, c11, c17, c23 };
     enum class target_optimizations     : std::uint32_t { o0      = 1, o1, o2, o3 };
+    enum class target_pgo_phases        : std::uint32_t { none    = 1, instrument, optimize };
+    enum class target_instruction_sets  : std::uint32_t { sse2    = 1, avx, avx2, avx512, native };
     enum class target_msvc_subsystems   : std::uint32_t { console = 1, window };
     
+    // Lets string keyed unordered containers be searched with a string_view.
+    struct transparent_string_hash {
+        using is_transparent = void;
+        std::size_t operator()(std::string_view s) const noexcept { return std::hash<std::string_view>{}(s); }
+    };
+
+    // What a description file says about one target, read once and handed to every generator.
+    // Empty strings and lists or disengaged optionals mean the property was not written.
+    struct target_config_properties {
+        std::string                               name;
+        std::vector<std::string>                  defines;
+        std::vector<std::string>                  external_links;
+        std::string                               binary_directory;
+        std::string                               intermediate_directory;
+        std::optional<target_optimizations>       optimization;
+        std::optional<target_instruction_sets>    instruction_set;
+        std::optional<bool>                       lto;
+        std::optional<target_pgo_phases>          pgo_phase;
+        std::optional<bool>                       msvc_incremental_link;
+        std::optional<bool>                       msvc_debug_fastlink;
+    };
+
+    struct target_properties {
+        std::string                               name;
+        std::vector<std::string>                  headers;
+        std::vector<std::string>                  sources;
+        std::vector<std::string>                  dependencies;
+        std::vector<std::string>                  external_link_directories;
+        std::vector<std::string>                  external_include_directories;
+        std::vector<std::string>                  public_include_directories;   // Public ones also reach every dependent.
+        std::vector<std::string>                  public_defines;
+        std::vector<std::string>                  public_external_links;
+        std::string                               msvc_icon;
+        std::string                               pch_header;
+        std::string                               pch_source;
+        std::optional<target_types>               type;
+        std::optional<target_cpp_standards>       std_cpp;
+        std::optional<target_c_standards>         std_c;
+        std::optional<target_msvc_subsystems>     msvc_subsystem;
+        std::optional<std::uint32_t>              unity_build;
+        std::optional<std::uint32_t>              msvc_multiprocessor;
+        std::optional<std::uint32_t>              msvc_codegen_threads;
+        std::vector<target_config_properties>     configs;   // In description order.
+    };
+
+    // One .make.cpp of the run, split before its project scope is compiled.
+    struct project_description {
+        std::string                                  path;
+        std::string                                  name;
+        std::vector<std::string>                     targets;
+        std::vector<std::string>                     configurations;
+        // #include lines of the project scope with their #line, every section starts with them.
+        std::string                                  includes;
+        // "project_scope" and one entry per target namespace.
+        std::unordered_map<std::string, std::string> source_fields;
+    };
+
+    // TARGET_DEPENDENCIES as a DAG, node i is the i-th entry of PROJECT_TARGETS.
+    struct target_graph {
+        std::vector<std::vector<std::size_t>>     dependencies;    // What i links against.
+        std::vector<std::vector<std::size_t>>     dependents;      // What links against i.
+        std::vector<std::size_t>                  order;           // Dependencies always before their dependents.
+        std::vector<std::size_t>                  depth;           // Targets on the longest chain ending at i, i included.
+        std::vector<std::size_t>                  critical_path;   // Longest chain, dependencies first.
+    };
+
     class visual_studio_project {
+    public:
+        // Everything emitters need from a "<platform>_<mode>" config, split once at construction.
+        struct config_descriptor {
+            std::string  name;        // x64_debug
+            std::string  mode;        // debug
+            std::string  platform;    // x64
+            std::string  tag;         // debug|x64
+            std::string  condition;   // '$(Configuration)|$(Platform)'=='debug|x64'
+            std::string  mode_upper;  // DEBUG
+        };
+
+        // Per target filter state, a directory is resolved only once and every filter
+        // in its ancestor chain gets exactly one Filter node.
+        struct filter_cache {
+            using string_map = std::unordered_map<std::string, std::string, transparent_string_hash, std::equal_to<>>;
+            using trie_node  = std::unordered_map<std::string, std::size_t, transparent_string_hash, std::equal_to<>>;
+
+            std::unordered_map<std::string, string_map>  directories;      // filter root -> raw directory -> filter path
+            std::vector<trie_node>                       filter_trie = std::vector<trie_node>(1); // path component -> child, 0 is root
+        };
+    private:
+        // Everything the solution keeps about one target, the id new_target interned its name to indexes it.
+        struct target_state {
+            std::string                 name;
+            std::string                 guid;
+            xmloxx::tree                project;
+            xmloxx::tree                filters;
+            filter_cache                filter_state;
+            std::vector<std::size_t>    dependencies;    // Ids, written as ProjectDependencies into the .sln.
+            bool                        precompiled_header = false;
+        };
+
+        std::pmr::memory_resource*                              resource_;
         std::string                                             solution_name_;
-        std::vector<std::string>                                solution_configs_;
-        // For visual studio project locate.
-        std::unordered_map<std::string_view, std::string>       vcxproj_guid_map_;
-        std::unordered_map<std::string_view, xmloxx::tree>      vcxproj_map_;
-        std::unordered_map<std::string_view, xmloxx::tree>      vcxproj_filters_map_;
-        std::unordered_map<std::string_view, std::string_view>  vcxproj_filter_name_map_;
+        std::vector<config_descriptor>                          solution_configs_;
+        // In new_target order, a deque so trees are never relocated or copied as targets are added.
+        std::deque<target_state>                                targets_;
+        std::unordered_map<std::string, std::size_t, transparent_string_hash, std::equal_to<>> target_ids_;
 
         enum AttachmentType {
             Attach_Headers        = 1,
@@ -52,13 +183,18 @@ namespace makexx {
             Attach_Resource       = 4,
             Attach_Dependency     = 5
         };
+
+        std::size_t find_config_(std::string_view config) const;
+        std::size_t find_target_(std::string_view target_name) const;
         
     public:
-        visual_studio_project(std::string_view sln_name, const std::vector<std::string>& configs);
+        visual_studio_project(std::string_view sln_name, const std::vector<std::string>& configs,
+            std::pmr::memory_resource* mr = std::pmr::get_default_resource());
         
-        visual_studio_project(const visual_studio_project&)            noexcept = default;
+        // Trees point into their own node storage, a copy would point into this one's.
+        visual_studio_project(const visual_studio_project&)                     = delete;
         visual_studio_project(visual_studio_project&&)                 noexcept = default;
-        visual_studio_project& operator=(const visual_studio_project&) noexcept = default;
+        visual_studio_project& operator=(const visual_studio_project&)          = delete;
         visual_studio_project& operator=(visual_studio_project&&)      noexcept = default;
 
         /////////////////////////////////////////////////////////////////////
@@ -75,12 +211,21 @@ namespace makexx {
         visual_studio_project& target_std_c          (std::string_view target_name, target_c_standards    version);
         
         visual_studio_project& target_msvc_subsystem      (std::string_view target_name, target_msvc_subsystems sys);
+        visual_studio_project& target_unity_build         (std::string_view target_name, std::uint32_t batch_size); // 0 disables
+        visual_studio_project& target_precompiled_header  (std::string_view target_name, std::string_view header, std::string_view source);
+        visual_studio_project& target_msvc_multiprocessor (std::string_view target_name, std::uint32_t jobs);    // /MP, 0 disables
+        visual_studio_project& target_msvc_codegen_threads(std::string_view target_name, std::uint32_t threads); // /cgthreads, 0 keeps default
         
         visual_studio_project& target_optimization           (std::string_view target_name, target_optimizations   op, std::string_view config);
         visual_studio_project& target_defines                (std::string_view target_name, const std::vector<std::string>& defines, std::string_view config); // Use ; as separator
         visual_studio_project& target_external_links         (std::string_view target_name, const std::vector<std::string>& links, std::string_view config);
         visual_studio_project& target_binary_directory       (std::string_view target_name, std::string_view dir, std::string_view config);
         visual_studio_project& target_intermediate_directory (std::string_view target_name, std::string_view dir, std::string_view config);
+        visual_studio_project& target_instruction_set        (std::string_view target_name, target_instruction_sets isa, std::string_view config);
+        visual_studio_project& target_lto                    (std::string_view target_name, bool enable, std::string_view config);
+        visual_studio_project& target_pgo_phase              (std::string_view target_name, target_pgo_phases phase, std::string_view config);
+        visual_studio_project& target_msvc_incremental_link  (std::string_view target_name, bool enable, std::string_view config);
+        visual_studio_project& target_msvc_debug_fastlink    (std::string_view target_name, bool enable, std::string_view config);
         //
         visual_studio_project& target_external_link_directories    (std::string_view target_name, const std::vector<std::string>& dirs);
         visual_studio_project& target_external_include_directories (std::string_view target_name, const std::vector<std::string>& dirs);
@@ -124,13 +269,38 @@ R"(-----------------------------------------------------------------------------
 -h/--help                : This command.
 -gh                      : Generate only platform dependent header with makeplusplus project structure.
 -gp <project-name>       : Generate complete project with makeplusplus project structure.
--gv <description-path>   : Generate visual studio solution and projects under '<project>' folder.
+-gv <description-path>...: Generate visual studio solution and projects under '<project>' folder.
+                           Several descriptions or directories of *.make.cpp are merged into one solution named
+                           after the first, their targets may depend on each other.
+-gc <description-path> [config]
+                         : Generate compile_commands.json in the project root, first configuration by default.
+-b <description-path> [config]
+                         : Compile and link all targets with the system c++ on all cores, skipping what is up to date.
+                           Objects are shared through a cache in MAKEXX_CACHE_DIR (default ~/.cache/makexx, empty disables)
+                           holding at most MAKEXX_CACHE_SIZE MiB (default 5120).
+--profile                : Append to any command to print the target graph and allocation statistics of this run.
 ---------------------------------------------------------------------------------------------------------------------
 )";
         
         int         argc_;
         char**      argv_;
+        bool        profile_ = false;
+
+        // All per-run temporaries live in arena_ and die together when the process exits.
+        // The two counters tell how many requests the arena absorbed and how few heap blocks it took.
+        counting_memory_resource             arena_upstream_;
+        std::pmr::monotonic_buffer_resource  arena_;
+        counting_memory_resource             arena_requests_;
+        // Heap blocks taken by the per-worker pools of compile_many, which do the bulk of the compiling.
+        counting_memory_resource             compile_upstream_;
+
+        // Object cache counters of the last -b run.
+        std::size_t                          cache_hits_      = 0;
+        std::size_t                          cache_misses_    = 0;
+        std::size_t                          cache_evictions_ = 0;
 
+        // Keys of definition_map_ view into definition_holder_, which lives in the arena.
+        std::pmr::string                                  definition_holder_;
         std::unordered_map<std::string_view, std::string> definition_map_;
 
         // Basic informations.
@@ -138,17 +308,32 @@ R"(-----------------------------------------------------------------------------
         std::vector<std::string>     mxx_project_targets;
         std::vector<std::string>     mxx_project_configurations;
 
-        std::unordered_map<std::string, std::string> mxx_project_source_fields_;
+        // Targets of all of them are merged into the lists above, in argument order.
+        std::vector<project_description>             mxx_project_descriptions_;
+        // Shared by every section of the run, created by read_source_and_split_targets_.
+        std::shared_ptr<cpod::include_cache>         include_cache_;
+        std::vector<target_properties>               mxx_project_target_properties_;
+        target_graph                                 mxx_project_graph_;
 
         void generate_header_();
         void generate_project_();
         void read_current_definition_map_();
-        void read_source_and_split_targets_();
-        void read_target_and_generate_vs_project_(const std::string& target, const std::string& source, visual_studio_project& vssln);
-        void generate_actual_visual_studio_project_();
+        bool read_source_and_split_targets_(const std::vector<std::string>& description_paths);
+        void read_target_properties_(cpod::archive& current_archive, const std::string& config, target_properties& props);
+        bool read_all_target_properties_();
+        bool build_target_graph_();
+        void resolve_usage_requirements_();
+        void generate_vs_target_(const target_properties& props, visual_studio_project& vssln);
+        bool generate_actual_visual_studio_project_();
+        bool read_targets_for_configuration_(std::string& config);
+        bool generate_compile_database_();
+        int  build_project_();
+        void print_profile_() const;
         
     public:
         make_application(int argc, char** argv);
+        make_application(const make_application&) = delete;
+        make_application& operator=(const make_application&) = delete;
         ~make_application() = default;
 
         int operator()();
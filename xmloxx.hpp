@@ -3,16 +3,32 @@
 #include <string>
 #include <vector>
 #include <ranges>
+#include <memory_resource>
 #include <algorithm>
 
 namespace xmloxx {
     
+    // Nodes are allocator aware so a whole tree can live in one arena.
+    using allocator_type = std::pmr::polymorphic_allocator<>;
+
     typedef struct attribute {
-        std::string key;
-        std::string value;
+        using allocator_type = xmloxx::allocator_type;
+
+        std::pmr::string key;
+        std::pmr::string value;
+
+        attribute(std::string_view k, std::string_view v, const allocator_type& a = {}) : key(k, a), value(v, a) {}
+
+        attribute(const attribute&) = default;
+        attribute(attribute&&) = default;
+        attribute(const attribute& right, const allocator_type& a) : key(right.key, a), value(right.value, a) {}
+        attribute(attribute&& right, const allocator_type& a) : key(std::move(right.key), a), value(std::move(right.value), a) {}
+        attribute& operator=(const attribute&) = default;
+        attribute& operator=(attribute&&) = default;
     } attribute;
 
     typedef struct node_data {
+        using allocator_type = xmloxx::allocator_type;
         
         typedef enum node_flags : std::uint8_t {
             flag_none        = static_cast<node_flags>(0),
@@ -21,19 +37,23 @@ namespace xmloxx {
             flag_begin_brace = static_cast<node_flags>(1 << 2),
         } node_flags;
         
-        node_flags                  flags = flag_none;
-        std::string                 name;
-        std::string                 content;
-        std::vector<attribute>  attributes;
+        node_flags                   flags = flag_none;
+        std::pmr::string             name;
+        std::pmr::string             content;
+        std::pmr::vector<attribute>  attributes;
 
         // For copy usage.
         node_data() = default;
-        node_data(std::string_view name, node_flags fs = flag_none) : flags(fs), name(name), content(), attributes() {
+        node_data(std::string_view name, node_flags fs = flag_none, const allocator_type& a = {}) : flags(fs), name(name, a), content(a), attributes(a) {
             attributes.reserve(8);
         }
 
         node_data(const node_data&) = default;
         node_data(node_data&&) = default;
+        node_data(const node_data& right, const allocator_type& a)
+        : flags(right.flags), name(right.name, a), content(right.content, a), attributes(right.attributes, a) {}
+        node_data(node_data&& right, const allocator_type& a)
+        : flags(right.flags), name(std::move(right.name), a), content(std::move(right.content), a), attributes(std::move(right.attributes), a) {}
         node_data& operator=(const node_data&) = default;
         node_data& operator=(node_data&&) = default;
         
@@ -44,12 +64,15 @@ namespace xmloxx {
         tree_node*                     parent_;
     public:
 
-        using iterator_attribute = std::vector<attribute>::iterator;
+        using iterator_attribute = std::pmr::vector<attribute>::iterator;
+        using allocator_type     = xmloxx::allocator_type;
         // For copy usage.
         tree_node() = default;
-        tree_node(std::string_view name, tree_node* p, node_data::node_flags fs = node_data::flag_none) : current_(name, fs), parent_(p) {}
+        tree_node(std::string_view name, tree_node* p, node_data::node_flags fs = node_data::flag_none, const allocator_type& a = {}) : current_(name, fs, a), parent_(p) {}
         tree_node(const tree_node& right) = default;
         tree_node(tree_node&& right) = default;
+        tree_node(const tree_node& right, const allocator_type& a) : current_(right.current_, a), parent_(right.parent_) {}
+        tree_node(tree_node&& right, const allocator_type& a) : current_(std::move(right.current_), a), parent_(right.parent_) {}
         tree_node& operator=(const tree_node& right) = default;
         tree_node& operator=(tree_node&&) = default;
         ~tree_node() = default;
@@ -58,7 +81,7 @@ namespace xmloxx {
         constexpr inline       tree_node* parent()       { return parent_; }
 
         constexpr inline tree_node* push_attribute(std::string_view key, std::string_view val) {
-            current_.attributes.emplace_back(key.data(), val.data());
+            current_.attributes.emplace_back(key, val);
             return this;
         }
 
@@ -132,15 +155,17 @@ namespace xmloxx {
 
 
     class tree {
-        std::vector<tree_node> nodes_;
+        std::pmr::vector<tree_node> nodes_;
     public:
         using iterator       = tree_node*;
         using const_iterator = const tree_node*;
         using node_type      = tree_node;
         
-        tree(std::string_view root_name, std::size_t cap = 1 << 10) {
+        // All nodes, names, contents and attributes are allocated from mr.
+        tree(std::string_view root_name, std::size_t cap = 1 << 10, std::pmr::memory_resource* mr = std::pmr::get_default_resource())
+        : nodes_(mr) {
             nodes_.reserve(cap);
-            nodes_.emplace_back(root_name, nullptr);
+            nodes_.emplace_back(root_name, nullptr, node_data::flag_none);
         }
         tree(const tree& right) = default;
         tree(tree&& right) = default;